@@ -0,0 +1,37 @@
+from __future__ import print_function
+# -------------------------------------------------------------------------
+# This is a benchmark of the registries that keep track of the native
+# instances created from Python (tinfo_t, cexpr_t, ...): registering and
+# deregistering an instance should take constant time, no matter how
+# many instances are alive.
+
+import time
+
+import ida_typeinf
+import ida_hexrays
+
+# -------------------------------------------------------------------------
+def bench(label, ctor, count):
+    t0 = time.time()
+    objs = [ctor() for i in xrange(count)]
+    t1 = time.time()
+    del objs
+    t2 = time.time()
+    print("%-10s %8d live: create %6.3fs (%5.2fus each), delete %6.3fs (%5.2fus each)" % (
+        label, count,
+        t1 - t0, (t1 - t0) * 1e6 / count,
+        t2 - t1, (t2 - t1) * 1e6 / count))
+
+
+# -------------------------------------------------------------------------
+def main():
+    for count in [10000, 100000, 1000000]:
+        bench("tinfo_t", ida_typeinf.tinfo_t, count)
+    if ida_hexrays.init_hexrays_plugin():
+        for count in [10000, 100000, 1000000]:
+            bench("cexpr_t", ida_hexrays.cexpr_t, count)
+
+
+# -------------------------------------------------------------------------
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,118 @@
+//---------------------------------------------------------------------
+// IDAPython - Python plugin for Interactive Disassembler
+//
+// Copyright (c) The IDAPython Team <idapython@googlegroups.com>
+//
+// All rights reserved.
+//
+// For detailed copyright information see the file COPYING in
+// the root of the distribution archive.
+//---------------------------------------------------------------------
+// mapped_file.cpp - Read-only file mappings
+//---------------------------------------------------------------------
+#ifdef __NT__
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include <pro.h>
+
+#include "mapped_file.hpp"
+
+//-------------------------------------------------------------------------
+struct mapped_file_handle_t
+{
+  const char *base;
+  size_t size;
+#ifdef __NT__
+  HANDLE hfile;
+  HANDLE hmap;
+#endif
+
+  mapped_file_handle_t() : base(NULL), size(0)
+#ifdef __NT__
+                         , hfile(INVALID_HANDLE_VALUE), hmap(NULL)
+#endif
+  {}
+
+  ~mapped_file_handle_t()
+  {
+#ifdef __NT__
+    if ( base != NULL )
+      UnmapViewOfFile(base);
+    if ( hmap != NULL )
+      CloseHandle(hmap);
+    if ( hfile != INVALID_HANDLE_VALUE )
+      CloseHandle(hfile);
+#else
+    if ( base != NULL )
+      munmap((void *) base, size);
+#endif
+  }
+
+  bool open(const char *path)
+  {
+#ifdef __NT__
+    hfile = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ|FILE_SHARE_WRITE,
+                        NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if ( hfile == INVALID_HANDLE_VALUE )
+      return false;
+    LARGE_INTEGER fsize;
+    if ( !GetFileSizeEx(hfile, &fsize) || uint64(fsize.QuadPart) > uint64(SIZE_MAX) )
+      return false;
+    size = size_t(fsize.QuadPart);
+    if ( size == 0 )
+      return true; // empty files cannot be mapped
+    hmap = CreateFileMappingA(hfile, NULL, PAGE_READONLY, 0, 0, NULL);
+    if ( hmap != NULL )
+      base = (const char *) MapViewOfFile(hmap, FILE_MAP_READ, 0, 0, 0);
+#else
+    int fd = ::open(path, O_RDONLY);
+    if ( fd < 0 )
+      return false;
+    struct stat st;
+    if ( fstat(fd, &st) != 0 || uint64(st.st_size) > uint64(SIZE_MAX) )
+    {
+      ::close(fd);
+      return false;
+    }
+    size = size_t(st.st_size);
+    if ( size == 0 )
+    {
+      ::close(fd);
+      return true;
+    }
+    void *p = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // the mapping keeps the file open
+    if ( p != MAP_FAILED )
+      base = (const char *) p;
+#endif
+    return base != NULL;
+  }
+};
+
+//-------------------------------------------------------------------------
+mapped_file_handle_t *ida_export idapython_map_file(
+        const char **base,
+        size_t *size,
+        const char *path)
+{
+  mapped_file_handle_t *h = new mapped_file_handle_t();
+  if ( !h->open(path) )
+  {
+    delete h;
+    return NULL;
+  }
+  *base = h->base;
+  *size = h->size;
+  return h;
+}
+
+//-------------------------------------------------------------------------
+void ida_export idapython_unmap_file(mapped_file_handle_t *h)
+{
+  delete h;
+}
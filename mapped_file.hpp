@@ -0,0 +1,19 @@
+#ifndef __MAPPED_FILE_HPP__
+#define __MAPPED_FILE_HPP__
+
+//-------------------------------------------------------------------------
+// Read-only mappings of whole files. The OS-specific code lives in
+// mapped_file.cpp, so that the wrappers only depend on the SDK headers.
+struct mapped_file_handle_t;
+
+// Maps 'path' in memory. Returns NULL on failure. An empty file cannot
+// be mapped: the call succeeds with '*base' set to NULL.
+idaman mapped_file_handle_t *ida_export idapython_map_file(
+        const char **base,
+        size_t *size,
+        const char *path);
+
+// Unmaps a file mapped with idapython_map_file(), and closes it
+idaman void ida_export idapython_unmap_file(mapped_file_handle_t *h);
+
+#endif // __MAPPED_FILE_HPP__
@@ -143,14 +143,17 @@ def XrefTypeName(typecode):
     assert typecode in _ref_types, "unknown reference type %d" % typecode
     return _ref_types[typecode]
 
+class _xref(object):
+    pass
+
 def _copy_xref(xref):
     """ Make a private copy of the xref class to preserve its contents """
-    class _xref(object):
-        pass
-
     xr = _xref()
-    for attr in [ 'frm', 'to', 'iscode', 'type', 'user' ]:
-        setattr(xr, attr, getattr(xref, attr))
+    xr.frm = xref.frm
+    xr.to = xref.to
+    xr.iscode = xref.iscode
+    xr.type = xref.type
+    xr.user = xref.user
     return xr
 
 
@@ -161,6 +164,9 @@ def XrefsFrom(ea, flags=0):
     @param ea: Reference address
     @param flags: any of ida_xref.XREF_* flags
 
+    The references are fetched one at a time; ida_xref.get_xrefs_from()
+    fetches them all at once, as parallel arrays.
+
     Example::
            for xref in XrefsFrom(here(), 0):
                print xref.type, XrefTypeName(xref.type), \
@@ -180,6 +186,9 @@ def XrefsTo(ea, flags=0):
     @param ea: Reference address
     @param flags: any of ida_xref.XREF_* flags
 
+    The references are fetched one at a time; ida_xref.get_xrefs_to()
+    fetches them all at once, as parallel arrays.
+
     Example::
            for xref in XrefsTo(here(), 0):
                print xref.type, XrefTypeName(xref.type), \
@@ -198,6 +207,11 @@ def Threads():
         yield idc.getn_thread(i)
 
 
+# Number of addresses that Heads(), Functions() and FuncItems()
+# fetch from the kernel at once.
+_ITER_CHUNK_SIZE = 1024
+
+
 def Heads(start=None, end=None):
     """
     Get a list of heads (instructions or data)
@@ -211,11 +225,13 @@ def Heads(start=None, end=None):
     if not end:   end = ida_ida.cvar.inf.max_ea
 
     ea = start
-    if not idc.is_head(ida_bytes.get_flags(ea)):
-        ea = ida_bytes.next_head(ea, end)
-    while ea != ida_idaapi.BADADDR:
-        yield ea
-        ea = ida_bytes.next_head(ea, end)
+    while True:
+        chunk = ida_bytes.get_heads_chunk(ea, end, _ITER_CHUNK_SIZE)
+        for head in chunk:
+            yield head
+        if len(chunk) < _ITER_CHUNK_SIZE:
+            break
+        ea = chunk[-1] + 1
 
 
 def Functions(start=None, end=None):
@@ -235,18 +251,13 @@ def Functions(start=None, end=None):
     if not start: start = ida_ida.cvar.inf.min_ea
     if not end:   end = ida_ida.cvar.inf.max_ea
 
-    # find first function head chunk in the range
-    chunk = ida_funcs.get_fchunk(start)
-    if not chunk:
-        chunk = ida_funcs.get_next_fchunk(start)
-    while chunk and chunk.start_ea < end and (chunk.flags & ida_funcs.FUNC_TAIL) != 0:
-        chunk = ida_funcs.get_next_fchunk(chunk.start_ea)
-    func = chunk
-
-    while func and func.start_ea < end:
-        startea = func.start_ea
-        yield startea
-        func = ida_funcs.get_next_func(startea)
+    chunk = ida_funcs.get_func_starts_chunk(start, end, _ITER_CHUNK_SIZE)
+    while True:
+        for startea in chunk:
+            yield startea
+        if len(chunk) < _ITER_CHUNK_SIZE:
+            break
+        chunk = ida_funcs.get_func_starts_chunk(chunk[-1], end, _ITER_CHUNK_SIZE, True)
 
 
 def Chunks(start):
@@ -258,12 +269,8 @@ def Chunks(start):
     @return: list of funcion chunks (tuples of the form (start_ea, end_ea))
              belonging to the function
     """
-    func_iter = ida_funcs.func_tail_iterator_t( ida_funcs.get_func( start ) )
-    status = func_iter.main()
-    while status:
-        chunk = func_iter.chunk()
-        yield (chunk.start_ea, chunk.end_ea)
-        status = next(func_iter)
+    for chunk in ida_funcs.get_func_chunks(start):
+        yield chunk
 
 
 def Modules():
@@ -283,9 +290,7 @@ def Names():
 
     @return: List of tuples (ea, name)
     """
-    for i in xrange(ida_name.get_nlist_size()):
-        ea   = ida_name.get_nlist_ea(i)
-        name = ida_name.get_nlist_name(i)
+    for ea, name in ida_name.get_nlist_entries():
         yield (ea, name)
 
 
@@ -323,14 +328,14 @@ def FuncItems(start):
 
     @return: ea of each item in the function
     """
-    func = ida_funcs.get_func(start)
-    if not func:
-        return
-    fii = ida_funcs.func_item_iterator_t()
-    ok = fii.set(func)
-    while ok:
-        yield fii.current()
-        ok = fii.next_code()
+    after = ida_idaapi.BADADDR
+    while True:
+        chunk = ida_funcs.get_func_items_chunk(start, after, _ITER_CHUNK_SIZE)
+        for ea in chunk:
+            yield ea
+        if len(chunk) < _ITER_CHUNK_SIZE:
+            break
+        after = chunk[-1]
 
 
 def Structs():
@@ -2013,11 +2013,11 @@ bool ida_export py_customidamemo_t_collect_pyobject_callbacks(
 //
 // Unfortunately the IDAPython plugin has to terminate _after_ the IDB is
 // closed, but the "type details" must be cleared _before_ the IDB is closed.
-static qvector<tinfo_t*> py_tinfo_t_vec;
-static qvector<ptr_type_data_t*> py_ptr_type_data_t_vec;
-static qvector<array_type_data_t*> py_array_type_data_t_vec;
-static qvector<func_type_data_t*> py_func_type_data_t_vec;
-static qvector<udt_type_data_t*> py_udt_type_data_t_vec;
+static ptr_registry_t<tinfo_t*> py_tinfo_t_vec;
+static ptr_registry_t<ptr_type_data_t*> py_ptr_type_data_t_vec;
+static ptr_registry_t<array_type_data_t*> py_array_type_data_t_vec;
+static ptr_registry_t<func_type_data_t*> py_func_type_data_t_vec;
+static ptr_registry_t<udt_type_data_t*> py_udt_type_data_t_vec;
 
 static void __clear(tinfo_t *inst) { inst->clear(); }
 static void __clear(ptr_type_data_t *inst) { inst->obj_type.clear(); inst->closure.clear(); }
@@ -2037,7 +2037,7 @@ static void til_clear_python_tinfo_t_instances(void)
   // NOTE: Don't clear() the arrays of pointers. All the python-exposed
   // instances will be deleted through the python shutdown/ref-decrementing
   // process anyway (which will cause til_deregister_..() calls), and the
-  // entries will be properly pulled out of the vector when that happens.
+  // entries will be properly pulled out of the registry when that happens.
 #define BATCH_CLEAR(Type)                                               \
   do                                                                    \
   {                                                                     \
@@ -2063,12 +2063,11 @@ static void til_clear_python_tinfo_t_instances(void)
                                                                         \
   void ida_export til_deregister_python_##Type##_instance(Type *inst) \
   {                                                                     \
-    qvector<Type*>::iterator found = py_##Type##_vec.find(inst);        \
-    if ( found != py_##Type##_vec.end() )                               \
+    if ( py_##Type##_vec.find(inst) != NULL )                           \
     {                                                                   \
       __clear(inst);                                                    \
       /* tif->clear();*/                                                \
-      py_##Type##_vec.erase(found);                                     \
+      py_##Type##_vec.del(inst);                                        \
     }                                                                   \
   }
 
@@ -105,6 +105,7 @@ static const char S_ON_GET_ICON[]            = "OnGetIcon";
 static const char S_ON_GET_LINE_ATTR[]       = "OnGetLineAttr";
 static const char S_ON_GET_SIZE[]            = "OnGetSize";
 static const char S_ON_GETTEXT[]             = "OnGetText";
+static const char S_ON_GETTEXT_BATCH[]       = "OnGetTextBatch";
 static const char S_ON_ACTIVATE[]            = "OnActivate";
 static const char S_ON_DEACTIVATE[]          = "OnDeactivate";
 static const char S_ON_SELECT[]              = "OnSelect";
@@ -114,6 +115,7 @@ static const char S_ON_GROUP_VISIBILITY[]    = "OnGroupVisibility";
 static const char S_ON_INIT[]                = "OnInit";
 static const char S_M_EDGES[]                = "_edges";
 static const char S_M_NODES[]                = "_nodes";
+static const char S_M_PACKED_EDGES[]         = "_packed_edges";
 static const char S_M_THIS[]                 = "_this";
 static const char S_M_TITLE[]                = "_title";
 static const char S_CLINK_NAME[]             = "__clink__";
@@ -437,6 +439,219 @@ idaman Py_ssize_t ida_export PyW_PyListToSizeVec(sizevec_t *out, PyObject *py_li
 idaman Py_ssize_t ida_export PyW_PyListToEaVec(eavec_t *out, PyObject *py_list);
 idaman Py_ssize_t ida_export PyW_PyListToStrVec(qstrvec_t *out, PyObject *py_list);
 
+// Packs the contents of a vector of plain numbers into a Python 'str',
+// so that large arrays can be handed to Python in one object.
+// (See ida_idaapi.unpack_packed_array() for the Python side.)
+// Return value: New reference.
+template <typename T>
+inline PyObject *PyW_PackVecToPyString(const qvector<T> &vec)
+{
+  return PyString_FromStringAndSize(
+          (const char *) vec.begin(),
+          Py_ssize_t(vec.size() * sizeof(T)));
+}
+
+//-------------------------------------------------------------------------
+// A map of non-overlapping [start, end) address ranges to values.
+// Setting a range overwrites (and trims, or splits) the ranges it
+// overlaps; lookups are logarithmic in the number of ranges.
+#include <map>
+template <typename T>
+class ea_interval_map_t
+{
+  struct ival_t
+  {
+    ea_t end;
+    T value;
+    ival_t() : end(0) {}
+    ival_t(ea_t _end, const T &_value) : end(_end), value(_value) {}
+  };
+  typedef std::map<ea_t, ival_t> ivals_t;
+  ivals_t ivals;
+
+public:
+  void clear() { ivals.clear(); }
+  size_t size() const { return ivals.size(); }
+  bool empty() const { return ivals.empty(); }
+
+  // Remove the values for [start, end)
+  void erase(ea_t start, ea_t end)
+  {
+    if ( start >= end )
+      return;
+    typename ivals_t::iterator p = ivals.lower_bound(start);
+    if ( p != ivals.begin() )
+    {
+      typename ivals_t::iterator q = p;
+      --q;
+      if ( q->second.end > start )
+      {
+        if ( q->second.end > end )
+          ivals[end] = ival_t(q->second.end, q->second.value);
+        q->second.end = start;
+      }
+    }
+    while ( p != ivals.end() && p->first < end )
+    {
+      if ( p->second.end > end )
+      {
+        ival_t tail = p->second;
+        ivals.erase(p);
+        ivals[end] = tail;
+        break;
+      }
+      ivals.erase(p++);
+    }
+  }
+
+  // Set the value for [start, end)
+  void set(ea_t start, ea_t end, const T &value)
+  {
+    if ( start >= end )
+      return;
+    erase(start, end);
+    ivals[start] = ival_t(end, value);
+  }
+
+  // Get the value for 'ea', or NULL
+  const T *find(ea_t ea) const
+  {
+    typename ivals_t::const_iterator p = ivals.upper_bound(ea);
+    if ( p == ivals.begin() )
+      return NULL;
+    --p;
+    return ea < p->second.end ? &p->second.value : NULL;
+  }
+
+  // Get the value of the first range intersecting [start, end), or NULL
+  const T *find_first(ea_t start, ea_t end) const
+  {
+    const T *v = find(start);
+    if ( v == NULL )
+    {
+      typename ivals_t::const_iterator p = ivals.upper_bound(start);
+      if ( p != ivals.end() && p->first < end )
+        v = &p->second.value;
+    }
+    return v;
+  }
+};
+
+//-------------------------------------------------------------------------
+// A set of objects identified by a pointer, with constant-time insertion,
+// removal and lookup. The elements are stored densely (in no particular
+// order), and an open-addressing hash table maps each key to its position.
+// The key of an element is given by registry_key().
+inline const void *registry_key(const void *p) { return p; }
+
+template <typename E>
+class ptr_registry_t
+{
+  qvector<E> items;
+  qvector<size_t> slots;  // position in 'items' + 1, or 0 if empty
+  size_t mask;
+
+  static size_t hash(const void *key)
+  {
+    uint64 h = uint64(size_t(key));
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    return size_t(h);
+  }
+
+  // Return the slot holding 'key', or the empty slot where it would go
+  size_t find_slot(const void *key) const
+  {
+    size_t i = hash(key) & mask;
+    while ( slots[i] != 0 && registry_key(items[slots[i]-1]) != key )
+      i = (i + 1) & mask;
+    return i;
+  }
+
+  void rehash(size_t nslots)
+  {
+    slots.qclear();
+    slots.resize(nslots, 0);
+    mask = nslots - 1;
+    for ( size_t i = 0; i < items.size(); ++i )
+      slots[find_slot(registry_key(items[i]))] = i + 1;
+  }
+
+  // Empty slot 'i', shifting back the entries of its probe sequence
+  void free_slot(size_t i)
+  {
+    for ( size_t j = (i + 1) & mask; slots[j] != 0; j = (j + 1) & mask )
+    {
+      size_t home = hash(registry_key(items[slots[j]-1])) & mask;
+      bool stays = i <= j ? (i < home && home <= j) : (i < home || home <= j);
+      if ( !stays )
+      {
+        slots[i] = slots[j];
+        i = j;
+      }
+    }
+    slots[i] = 0;
+  }
+
+public:
+  ptr_registry_t() : mask(0) {}
+
+  size_t size() const { return items.size(); }
+  bool empty() const { return items.empty(); }
+  const E &operator[](size_t i) const { return items[i]; }
+  E &operator[](size_t i) { return items[i]; }
+
+  void clear()
+  {
+    items.clear();
+    slots.clear();
+    mask = 0;
+  }
+
+  E *find(const void *key)
+  {
+    if ( items.empty() )
+      return NULL;
+    size_t s = slots[find_slot(key)];
+    return s == 0 ? NULL : &items[s-1];
+  }
+
+  // Returns false if an element with the same key is already present
+  bool add_unique(const E &e)
+  {
+    if ( (items.size() + 1) * 2 > slots.size() )
+      rehash(qmax(slots.size() * 2, size_t(16)));
+    size_t i = find_slot(registry_key(e));
+    if ( slots[i] != 0 )
+      return false;
+    items.push_back(e);
+    slots[i] = items.size();
+    return true;
+  }
+
+  // Returns false if there is no element with that key
+  bool del(const void *key)
+  {
+    if ( items.empty() )
+      return false;
+    size_t i = find_slot(key);
+    if ( slots[i] == 0 )
+      return false;
+    size_t pos = slots[i] - 1;
+    free_slot(i);
+    // fill the hole with the last element
+    size_t last = items.size() - 1;
+    if ( pos != last )
+    {
+      slots[find_slot(registry_key(items[last]))] = pos + 1;
+      items[pos] = items[last];
+    }
+    items.pop_back();
+    return true;
+  }
+};
+
 //-------------------------------------------------------------------------
 idaman bool ida_export PyWStringOrNone_Check(PyObject *tp);
 
@@ -836,6 +1051,130 @@ idaman bool ida_export idapython_unhook_from_notification_point(
 #define hook_to_notification_point USE_IDAPYTHON_HOOK_TO_NOTIFICATION_POINT
 #define unhook_from_notification_point USE_IDAPYTHON_UNHOOK_FROM_NOTIFICATION_POINT
 
+//-------------------------------------------------------------------------
+// How an IDB event changes the text rendered from the database. Used by
+// the caches of rendered text (disassembly lines, pseudocode), so that
+// they agree on what to drop.
+#include <idp.hpp>
+#include <bytes.hpp>
+#include <funcs.hpp>
+enum idb_change_t
+{
+  IDBCH_NONE,   // nothing is rendered differently
+  IDBCH_COLOR,  // the color of the items in [ea1, ea2)
+  IDBCH_ITEMS,  // the items in [ea1, ea2)
+  IDBCH_FUNC,   // the function at 'ea1' (its chunks, frame, stack points)
+  IDBCH_ALL,    // anything: names, segments, types, the items
+                // referencing a changed one (repeatable comments,
+                // types of functions and data)...
+};
+
+inline idb_change_t classify_idb_event(ea_t *ea1, ea_t *ea2, int code, va_list va)
+{
+  idb_change_t change = IDBCH_ITEMS;
+  ea_t ea = BADADDR;
+  switch ( code )
+  {
+    case idb_event::item_color_changed:
+      change = IDBCH_COLOR;
+      ea = va_arg(va, ea_t);
+      break;
+    case idb_event::byte_patched:
+    case idb_event::extra_cmt_changed:
+    case idb_event::op_type_changed:
+    case idb_event::op_ti_changed:
+    case idb_event::make_data:
+    case idb_event::callee_addr_changed:
+      ea = va_arg(va, ea_t);
+      break;
+    case idb_event::make_code:
+      ea = va_arg(va, const insn_t *)->ea;
+      break;
+    case idb_event::cmt_changed:
+      {
+        ea = va_arg(va, ea_t);
+        bool repeatable = bool(va_arg(va, int));
+        if ( repeatable )
+          return IDBCH_ALL;
+      }
+      break;
+    case idb_event::ti_changed:
+      {
+        ea = va_arg(va, ea_t);
+        func_t *pfn = get_func(ea);
+        if ( (pfn != NULL && pfn->start_ea == ea) || is_data(get_flags(ea)) )
+          return IDBCH_ALL;
+      }
+      break;
+    case idb_event::destroyed_items:
+    case idb_event::sgr_changed:
+    case idb_event::sgr_deleted:
+      *ea1 = va_arg(va, ea_t);
+      *ea2 = va_arg(va, ea_t);
+      return IDBCH_ITEMS;
+    case idb_event::func_updated:
+    case idb_event::stkpnts_changed:
+    case idb_event::deleting_func:
+    case idb_event::frame_deleted:
+    case idb_event::set_func_start:
+    case idb_event::set_func_end:
+    case idb_event::func_tail_appended:
+    case idb_event::func_tail_deleted:
+      *ea1 = va_arg(va, func_t *)->start_ea;
+      *ea2 = *ea1 + 1;
+      return IDBCH_FUNC;
+    case idb_event::renamed:
+    case idb_event::range_cmt_changed:
+    case idb_event::local_types_changed:
+    case idb_event::compiler_changed:
+    case idb_event::func_added:
+    case idb_event::func_noret_changed:
+    case idb_event::thunk_func_created:
+    case idb_event::tail_owner_changed:
+    case idb_event::segm_added:
+    case idb_event::deleting_segm:
+    case idb_event::segm_deleted:
+    case idb_event::segm_start_changed:
+    case idb_event::segm_end_changed:
+    case idb_event::segm_name_changed:
+    case idb_event::segm_class_changed:
+    case idb_event::segm_attrs_updated:
+    case idb_event::segm_moved:
+    case idb_event::allsegs_moved:
+    case idb_event::struc_created:
+    case idb_event::struc_deleted:
+    case idb_event::struc_renamed:
+    case idb_event::struc_expanded:
+    case idb_event::struc_cmt_changed:
+    case idb_event::struc_align_changed:
+    case idb_event::struc_member_created:
+    case idb_event::struc_member_deleted:
+    case idb_event::struc_member_renamed:
+    case idb_event::struc_member_changed:
+    case idb_event::enum_created:
+    case idb_event::enum_deleted:
+    case idb_event::enum_renamed:
+    case idb_event::enum_bf_changed:
+    case idb_event::enum_cmt_changed:
+    case idb_event::enum_member_created:
+    case idb_event::enum_member_deleted:
+      return IDBCH_ALL;
+    // anything else (the changing_... events, which are followed by
+    // the corresponding ..._changed one, bookmarks, analysis progress,
+    // saving the database...) doesn't change the rendered text
+    default:
+      return IDBCH_NONE;
+  }
+  *ea1 = get_item_head(ea);
+  *ea2 = get_item_end(*ea1);
+  if ( *ea2 <= *ea1 )
+    *ea2 = *ea1 + 1;
+  return change;
+}
+
+//-------------------------------------------------------------------------
+#include "mapped_file.hpp"
+
 //-------------------------------------------------------------------------
 idaman bool ida_export idapython_convert_cli_completions(
         qstrvec_t *out_completions,
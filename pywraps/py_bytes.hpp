@@ -323,6 +323,45 @@ static PyObject *py_get_8bit(ea_t ea, uint32 v, int nbit)
   uchar octet = get_8bit(&ea, &v, &nbit);
   return Py_BuildValue("(i" PY_BV_EA "ki)", int(uint32(octet)), bvea_t(ea), v, nbit);
 }
+
+//-------------------------------------------------------------------------
+/*
+#<pydoc>
+def get_heads_chunk(start, end, maxcnt):
+    """
+    Collect up to 'maxcnt' heads (instructions or data) in [start, end),
+    in a single call. This is what idautils.Heads() uses, instead of
+    calling next_head() once per item.
+
+    @param start: start address. It is part of the result if it is a head.
+    @param end: end address (excluded)
+    @param maxcnt: maximum number of addresses to return
+    @return: a list of addresses. If it holds less than 'maxcnt'
+             entries, there are no more heads in the range.
+    """
+    pass
+#</pydoc>
+*/
+static PyObject *get_heads_chunk(ea_t start, ea_t end, size_t maxcnt)
+{
+  eavec_t heads;
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  Py_BEGIN_ALLOW_THREADS;
+  ea_t ea = start;
+  if ( ea >= end )
+    ea = BADADDR;
+  else if ( !is_head(get_flags(ea)) )
+    ea = next_head(ea, end);
+  while ( ea != BADADDR && heads.size() < maxcnt )
+  {
+    heads.push_back(ea);
+    ea = next_head(ea, end);
+  }
+  Py_END_ALLOW_THREADS;
+  ref_t result(PyW_UvalVecToPyList(heads));
+  result.incref();
+  return result.o;
+}
 //</inline(py_bytes)>
 
 #endif
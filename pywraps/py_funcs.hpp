@@ -82,4 +82,142 @@ static func_t *func_t__from_ptrval__(size_t ptrval)
 {
   return (func_t *) ptrval;
 }
+
+//-------------------------------------------------------------------------
+/*
+#<pydoc>
+def get_func_starts_chunk(start, end, maxcnt, cont=False):
+    """
+    Collect up to 'maxcnt' function entry addresses in one call.
+    This is what idautils.Functions() uses.
+
+    @param start: if 'cont' is False, the lookup starts with the first
+                  function entry chunk at, or after, 'start'.
+                  Otherwise, 'start' is the entry of the last function
+                  that was returned, and the lookup resumes after it.
+    @param end: functions starting at, or after 'end' are not returned
+    @param maxcnt: maximum number of addresses to return
+    @param cont: see 'start'
+    @return: a list of addresses. If it holds less than 'maxcnt'
+             entries, there are no more functions in the range.
+    """
+    pass
+#</pydoc>
+*/
+static PyObject *get_func_starts_chunk(
+        ea_t start,
+        ea_t end,
+        size_t maxcnt,
+        bool cont=false)
+{
+  eavec_t starts;
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  Py_BEGIN_ALLOW_THREADS;
+  func_t *pfn;
+  if ( cont )
+  {
+    pfn = get_next_func(start);
+  }
+  else
+  {
+    // find first function head chunk in the range
+    pfn = get_fchunk(start);
+    if ( pfn == NULL )
+      pfn = get_next_fchunk(start);
+    while ( pfn != NULL && pfn->start_ea < end && (pfn->flags & FUNC_TAIL) != 0 )
+      pfn = get_next_fchunk(pfn->start_ea);
+  }
+  while ( pfn != NULL && pfn->start_ea < end && starts.size() < maxcnt )
+  {
+    starts.push_back(pfn->start_ea);
+    pfn = get_next_func(pfn->start_ea);
+  }
+  Py_END_ALLOW_THREADS;
+  ref_t result(PyW_UvalVecToPyList(starts));
+  result.incref();
+  return result.o;
+}
+
+//-------------------------------------------------------------------------
+/*
+#<pydoc>
+def get_func_chunks(ea):
+    """
+    Get the chunks of the function containing 'ea', main chunk first.
+    This is what idautils.Chunks() uses.
+
+    @param ea: any address belonging to the function
+    @return: a list of (start_ea, end_ea) tuples (empty if there is
+             no function at 'ea')
+    """
+    pass
+#</pydoc>
+*/
+static PyObject *get_func_chunks(ea_t ea)
+{
+  rangevec_t chunks;
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  Py_BEGIN_ALLOW_THREADS;
+  func_t *pfn = get_func(ea);
+  if ( pfn != NULL )
+  {
+    func_tail_iterator_t fti(pfn);
+    for ( bool ok = fti.main(); ok; ok = fti.next() )
+      chunks.push_back(fti.chunk());
+  }
+  Py_END_ALLOW_THREADS;
+  size_t n = chunks.size();
+  newref_t py_list(PyList_New(n));
+  for ( size_t i = 0; i < n; ++i )
+  {
+    const range_t &r = chunks[i];
+    PyList_SetItem(py_list.o, i, Py_BuildValue("(" PY_BV_EA PY_BV_EA ")",
+                                               bvea_t(r.start_ea),
+                                               bvea_t(r.end_ea)));
+  }
+  py_list.incref();
+  return py_list.o;
+}
+
+//-------------------------------------------------------------------------
+/*
+#<pydoc>
+def get_func_items_chunk(func_ea, after, maxcnt):
+    """
+    Collect up to 'maxcnt' code items of a function in one call.
+    This is what idautils.FuncItems() uses.
+
+    @param func_ea: any address belonging to the function
+    @param after: BADADDR to start with the function entry, or the
+                  last item that was returned by a previous call
+    @param maxcnt: maximum number of addresses to return
+    @return: a list of addresses. If it holds less than 'maxcnt'
+             entries, there are no more items in the function.
+    """
+    pass
+#</pydoc>
+*/
+static PyObject *get_func_items_chunk(ea_t func_ea, ea_t after, size_t maxcnt)
+{
+  eavec_t items;
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  Py_BEGIN_ALLOW_THREADS;
+  func_t *pfn = get_func(func_ea);
+  if ( pfn != NULL )
+  {
+    func_item_iterator_t fii;
+    bool ok = fii.set(pfn, after);
+    if ( ok && after != BADADDR )
+      ok = fii.next_code();
+    while ( ok && items.size() < maxcnt )
+    {
+      items.push_back(fii.current());
+      ok = fii.next_code();
+    }
+  }
+  Py_END_ALLOW_THREADS;
+  ref_t result(PyW_UvalVecToPyList(items));
+  result.incref();
+  return result.o;
+}
 //</inline(py_funcs)>
@@ -0,0 +1,505 @@
+
+//-------------------------------------------------------------------------
+//<code(py_gdl)>
+//-------------------------------------------------------------------------
+// The blocks of a flow chart, as a graph in compressed-sparse-row form:
+// the successors of block #i are succs[succ_offsets[i]:succ_offsets[i+1]],
+// and likewise for the predecessors.
+struct fc_csr_graph_t
+{
+  int nnodes;
+  intvec_t succ_offsets;
+  intvec_t succs;
+  intvec_t pred_offsets;
+  intvec_t preds;
+
+  fc_csr_graph_t() : nnodes(0) {}
+
+  int nsucc(int n) const { return succ_offsets[n+1] - succ_offsets[n]; }
+  const int *succ_begin(int n) const { return succs.begin() + succ_offsets[n]; }
+  const int *succ_end(int n) const { return succs.begin() + succ_offsets[n+1]; }
+  const int *pred_begin(int n) const { return preds.begin() + pred_offsets[n]; }
+  const int *pred_end(int n) const { return preds.begin() + pred_offsets[n+1]; }
+
+  void init(const qflow_chart_t &fc);
+  void calc_preds();
+  void reverse(fc_csr_graph_t *out, int exit_node) const;
+  void calc_rpo(intvec_t *out, int entry) const;
+  void calc_idoms(intvec_t *out, int entry) const;
+  void calc_sccs(intvec_t *out) const;
+  void calc_loops(intvec_t *headers, intvec_t *depths, const intvec_t &idoms) const;
+};
+
+//-------------------------------------------------------------------------
+void fc_csr_graph_t::init(const qflow_chart_t &fc)
+{
+  nnodes = fc.size();
+  succ_offsets.resize(nnodes + 1);
+  succs.clear();
+  for ( int i = 0; i < nnodes; ++i )
+  {
+    succ_offsets[i] = succs.size();
+    const qbasic_block_t &bb = fc.blocks[i];
+    succs.insert(succs.end(), bb.succ.begin(), bb.succ.end());
+  }
+  succ_offsets[nnodes] = succs.size();
+  calc_preds();
+}
+
+//-------------------------------------------------------------------------
+// compute the predecessors from the successors (qflow_chart_t only
+// has them with FC_PREDS)
+void fc_csr_graph_t::calc_preds()
+{
+  pred_offsets.clear();
+  pred_offsets.resize(nnodes + 1, 0);
+  for ( size_t i = 0; i < succs.size(); ++i )
+    pred_offsets[succs[i] + 1]++;
+  for ( int i = 0; i < nnodes; ++i )
+    pred_offsets[i+1] += pred_offsets[i];
+  preds.resize(succs.size());
+  intvec_t pos(pred_offsets);
+  for ( int i = 0; i < nnodes; ++i )
+    for ( const int *p = succ_begin(i); p != succ_end(i); ++p )
+      preds[pos[*p]++] = i;
+}
+
+//-------------------------------------------------------------------------
+// Build the reverse graph, with an additional node 'exit_node' (== nnodes)
+// that leads to all the blocks without successors.
+void fc_csr_graph_t::reverse(fc_csr_graph_t *out, int exit_node) const
+{
+  out->nnodes = nnodes + 1;
+  out->succ_offsets.resize(nnodes + 2);
+  out->succs.clear();
+  for ( int i = 0; i < nnodes; ++i )
+  {
+    out->succ_offsets[i] = out->succs.size();
+    out->succs.insert(out->succs.end(), pred_begin(i), pred_end(i));
+  }
+  out->succ_offsets[exit_node] = out->succs.size();
+  for ( int i = 0; i < nnodes; ++i )
+    if ( nsucc(i) == 0 )
+      out->succs.push_back(i);
+  out->succ_offsets[exit_node + 1] = out->succs.size();
+  out->calc_preds();
+}
+
+//-------------------------------------------------------------------------
+void fc_csr_graph_t::calc_rpo(intvec_t *out, int entry) const
+{
+  out->clear();
+  if ( entry < 0 || entry >= nnodes )
+    return;
+  qvector<bool> seen;
+  seen.resize(nnodes, false);
+  // depth-first search with an explicit stack of (node, next successor)
+  qvector<std::pair<int, int> > stack;
+  stack.push_back(std::make_pair(entry, succ_offsets[entry]));
+  seen[entry] = true;
+  while ( !stack.empty() )
+  {
+    std::pair<int, int> &top = stack.back();
+    int n = top.first;
+    if ( top.second < succ_offsets[n+1] )
+    {
+      int s = succs[top.second++];
+      if ( !seen[s] )
+      {
+        seen[s] = true;
+        stack.push_back(std::make_pair(s, succ_offsets[s]));
+      }
+    }
+    else
+    {
+      out->push_back(n);
+      stack.pop_back();
+    }
+  }
+  std::reverse(out->begin(), out->end());
+}
+
+//-------------------------------------------------------------------------
+// Immediate dominators, with the algorithm of Cooper, Harvey & Kennedy.
+// The entry and the unreachable nodes get -1.
+void fc_csr_graph_t::calc_idoms(intvec_t *out, int entry) const
+{
+  out->clear();
+  out->resize(nnodes, -1);
+  intvec_t rpo;
+  calc_rpo(&rpo, entry);
+  if ( rpo.empty() )
+    return;
+  intvec_t order;
+  order.resize(nnodes, -1);
+  for ( size_t i = 0; i < rpo.size(); ++i )
+    order[rpo[i]] = int(i);
+  intvec_t &idom = *out;
+  idom[entry] = entry;
+  for ( bool changed = true; changed; )
+  {
+    changed = false;
+    for ( size_t i = 1; i < rpo.size(); ++i )
+    {
+      int b = rpo[i];
+      int new_idom = -1;
+      for ( const int *p = pred_begin(b); p != pred_end(b); ++p )
+      {
+        int pr = *p;
+        if ( idom[pr] < 0 )
+          continue;
+        if ( new_idom < 0 )
+        {
+          new_idom = pr;
+          continue;
+        }
+        int f1 = pr;
+        int f2 = new_idom;
+        while ( f1 != f2 )
+        {
+          while ( order[f1] > order[f2] )
+            f1 = idom[f1];
+          while ( order[f2] > order[f1] )
+            f2 = idom[f2];
+        }
+        new_idom = f1;
+      }
+      if ( idom[b] != new_idom )
+      {
+        idom[b] = new_idom;
+        changed = true;
+      }
+    }
+  }
+  idom[entry] = -1;
+}
+
+//-------------------------------------------------------------------------
+// Strongly connected components (Tarjan's algorithm, without recursion).
+// The components are numbered in reverse topological order.
+void fc_csr_graph_t::calc_sccs(intvec_t *out) const
+{
+  out->clear();
+  out->resize(nnodes, -1);
+  intvec_t index, lowlink, stack;
+  index.resize(nnodes, -1);
+  lowlink.resize(nnodes, 0);
+  qvector<bool> on_stack;
+  on_stack.resize(nnodes, false);
+  qvector<std::pair<int, int> > calls;
+  int counter = 0;
+  int nsccs = 0;
+  for ( int root = 0; root < nnodes; ++root )
+  {
+    if ( index[root] >= 0 )
+      continue;
+    calls.push_back(std::make_pair(root, succ_offsets[root]));
+    index[root] = lowlink[root] = counter++;
+    stack.push_back(root);
+    on_stack[root] = true;
+    while ( !calls.empty() )
+    {
+      std::pair<int, int> &top = calls.back();
+      int n = top.first;
+      if ( top.second < succ_offsets[n+1] )
+      {
+        int s = succs[top.second++];
+        if ( index[s] < 0 )
+        {
+          index[s] = lowlink[s] = counter++;
+          stack.push_back(s);
+          on_stack[s] = true;
+          calls.push_back(std::make_pair(s, succ_offsets[s]));
+        }
+        else if ( on_stack[s] )
+        {
+          lowlink[n] = qmin(lowlink[n], index[s]);
+        }
+        continue;
+      }
+      calls.pop_back();
+      if ( !calls.empty() )
+      {
+        int parent = calls.back().first;
+        lowlink[parent] = qmin(lowlink[parent], lowlink[n]);
+      }
+      if ( lowlink[n] == index[n] )
+      {
+        int m;
+        do
+        {
+          m = stack.back();
+          stack.pop_back();
+          on_stack[m] = false;
+          (*out)[m] = nsccs;
+        } while ( m != n );
+        nsccs++;
+      }
+    }
+  }
+}
+
+//-------------------------------------------------------------------------
+// Natural loops: an edge n->h where h dominates n is a back edge, and
+// the loop of 'h' holds the nodes that reach 'n' without going through
+// 'h'. Loops sharing a header are merged. For each node, 'headers'
+// receives the header of the innermost loop holding it (or -1), and
+// 'depths' the number of loops holding it.
+// Irreducible cycles, which have no dominating header, are not loops.
+void fc_csr_graph_t::calc_loops(intvec_t *headers, intvec_t *depths, const intvec_t &idoms) const
+{
+  headers->clear();
+  headers->resize(nnodes, -1);
+  depths->clear();
+  depths->resize(nnodes, 0);
+
+  // collect the sources of the back edges of every header first, so
+  // that each loop is walked once
+  qvector<intvec_t> tails;
+  tails.resize(nnodes);
+  intvec_t loop_headers;
+  for ( int n = 0; n < nnodes; ++n )
+  {
+    for ( const int *p = succ_begin(n); p != succ_end(n); ++p )
+    {
+      int h = *p;
+      // does 'h' dominate 'n'?
+      int d = n;
+      while ( d >= 0 && d != h )
+        d = idoms[d];
+      if ( d != h )
+        continue;
+      if ( tails[h].empty() )
+        loop_headers.push_back(h);
+      tails[h].push_back(n);
+    }
+  }
+
+  qvector<intvec_t> bodies;   // loop bodies, indexed like 'loop_headers'
+  bodies.resize(loop_headers.size());
+  intvec_t mark;              // the loop being walked, for its members
+  mark.resize(nnodes, -1);
+  intvec_t work;
+  for ( size_t loop = 0; loop < loop_headers.size(); ++loop )
+  {
+    int h = loop_headers[loop];
+    intvec_t &body = bodies[loop];
+    // the header is marked first: the walk never goes through it
+    mark[h] = int(loop);
+    body.push_back(h);
+    work.clear();
+    const intvec_t &t = tails[h];
+    for ( size_t i = 0; i < t.size(); ++i )
+    {
+      if ( mark[t[i]] != int(loop) )
+      {
+        mark[t[i]] = int(loop);
+        body.push_back(t[i]);
+        work.push_back(t[i]);
+      }
+    }
+    while ( !work.empty() )
+    {
+      int m = work.back();
+      work.pop_back();
+      for ( const int *q = pred_begin(m); q != pred_end(m); ++q )
+      {
+        if ( mark[*q] != int(loop) )
+        {
+          mark[*q] = int(loop);
+          body.push_back(*q);
+          work.push_back(*q);
+        }
+      }
+    }
+  }
+
+  // outer loops are bigger than the loops they contain: assign the
+  // biggest first, so that the innermost loop wins
+  qvector<std::pair<size_t, int> > by_size;
+  for ( size_t i = 0; i < bodies.size(); ++i )
+    by_size.push_back(std::make_pair(bodies[i].size(), int(i)));
+  std::sort(by_size.begin(), by_size.end());
+  for ( size_t i = by_size.size(); i > 0; --i )
+  {
+    int loop = by_size[i-1].second;
+    const intvec_t &body = bodies[loop];
+    for ( size_t j = 0; j < body.size(); ++j )
+    {
+      (*headers)[body[j]] = loop_headers[loop];
+      (*depths)[body[j]]++;
+    }
+  }
+}
+
+#ifdef TESTABLE_BUILD
+//-------------------------------------------------------------------------
+// Regression check for calc_loops(): two nested loops, with several back
+// edges to the inner header (3->2, 5->2) and one to the outer one (4->1):
+//   0->1, 1->2, 2->3, 3->2, 3->4, 4->1, 4->5, 5->2
+static void fc_csr_graph_selftest()
+{
+  static const int succ_offsets[] = { 0, 1, 2, 3, 5, 7, 8 };
+  static const int succs[] = { 1, 2, 3, 2, 4, 1, 5, 2 };
+  static const int exp_headers[] = { -1, 1, 2, 2, 2, 2 };
+  static const int exp_depths[] = { 0, 1, 2, 2, 2, 2 };
+  fc_csr_graph_t g;
+  g.nnodes = qnumber(succ_offsets) - 1;
+  g.succ_offsets.insert(g.succ_offsets.end(), succ_offsets, succ_offsets + qnumber(succ_offsets));
+  g.succs.insert(g.succs.end(), succs, succs + qnumber(succs));
+  g.calc_preds();
+  intvec_t idoms, headers, depths;
+  g.calc_idoms(&idoms, 0);
+  g.calc_loops(&headers, &depths, idoms);
+  for ( int i = 0; i < g.nnodes; ++i )
+  {
+    QASSERT(30621, headers[i] == exp_headers[i]);
+    QASSERT(30622, depths[i] == exp_depths[i]);
+  }
+}
+#endif // TESTABLE_BUILD
+//</code(py_gdl)>
+
+//<inline(py_gdl)>
+//-------------------------------------------------------------------------
+/*
+#<pydoc>
+def export_flowchart(fc):
+    """
+    Export the blocks of a flow chart in one call, as packed 'str'
+    buffers in native byte order (see ida_idaapi.unpack_packed_array()).
+
+    The successors of block #i are succs[succ_offsets[i]:succ_offsets[i+1]],
+    and its predecessors preds[pred_offsets[i]:pred_offsets[i+1]]. The
+    predecessors are available even if the flow chart was built without
+    FC_PREDS.
+
+    @param fc: a qflow_chart_t
+    @return: a tuple (starts, ends, types, (succ_offsets, succs), (pred_offsets, preds)).
+             'starts' and 'ends' hold ea_t's, the others 32-bit integers.
+             'types' holds fc_block_type_t values.
+    """
+    pass
+#</pydoc>
+*/
+static PyObject *export_flowchart(qflow_chart_t *fc)
+{
+  eavec_t starts;
+  eavec_t ends;
+  intvec_t types;
+  fc_csr_graph_t g;
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  Py_BEGIN_ALLOW_THREADS;
+  int n = fc->size();
+  starts.resize(n);
+  ends.resize(n);
+  types.resize(n);
+  for ( int i = 0; i < n; ++i )
+  {
+    starts[i] = fc->blocks[i].start_ea;
+    ends[i] = fc->blocks[i].end_ea;
+    types[i] = fc->calc_block_type(i);
+  }
+  g.init(*fc);
+  Py_END_ALLOW_THREADS;
+  newref_t py_starts(PyW_PackVecToPyString(starts));
+  newref_t py_ends(PyW_PackVecToPyString(ends));
+  newref_t py_types(PyW_PackVecToPyString(types));
+  newref_t py_succ_offsets(PyW_PackVecToPyString(g.succ_offsets));
+  newref_t py_succs(PyW_PackVecToPyString(g.succs));
+  newref_t py_pred_offsets(PyW_PackVecToPyString(g.pred_offsets));
+  newref_t py_preds(PyW_PackVecToPyString(g.preds));
+  return Py_BuildValue("(OOO(OO)(OO))",
+                       py_starts.o, py_ends.o, py_types.o,
+                       py_succ_offsets.o, py_succs.o,
+                       py_pred_offsets.o, py_preds.o);
+}
+
+//-------------------------------------------------------------------------
+// What analyze_flowchart() computes
+#define FCA_RPO       0 // reverse postorder of the blocks reachable from the entry
+#define FCA_IDOMS     1 // immediate dominators
+#define FCA_IPDOMS    2 // immediate post-dominators
+#define FCA_SCCS      3 // strongly connected components
+#define FCA_LOOPS     4 // innermost loop headers
+#define FCA_LOOPDEPTH 5 // loop nesting depths
+
+/*
+#<pydoc>
+def analyze_flowchart(fc, what):
+    """
+    Compute a property of the blocks of a flow chart. The entry is
+    block #0.
+
+      - FCA_RPO: the ids of the blocks reachable from the entry,
+        in reverse postorder
+      - FCA_IDOMS: the immediate dominator of each block (-1 for the
+        entry and the unreachable blocks)
+      - FCA_IPDOMS: the immediate post-dominator of each block. The blocks
+        without successors are post-dominated by a virtual exit node, and
+        get -1, as do the blocks that cannot reach any such block.
+      - FCA_SCCS: the number of the strongly connected component of each
+        block. The components are numbered in reverse topological order.
+      - FCA_LOOPS: the header of the innermost natural loop holding each
+        block (-1 if none). Irreducible cycles are not considered loops.
+      - FCA_LOOPDEPTH: the number of natural loops holding each block
+
+    @param fc: a qflow_chart_t
+    @param what: one of FCA_... constants
+    @return: a packed 'str' buffer of 32-bit integers (see
+             ida_idaapi.unpack_packed_array()), or None if 'what' is invalid
+    """
+    pass
+#</pydoc>
+*/
+static PyObject *analyze_flowchart(qflow_chart_t *fc, int what)
+{
+  if ( what < FCA_RPO || what > FCA_LOOPDEPTH )
+    Py_RETURN_NONE;
+  intvec_t result;
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  Py_BEGIN_ALLOW_THREADS;
+  fc_csr_graph_t g;
+  g.init(*fc);
+  switch ( what )
+  {
+    case FCA_RPO:
+      g.calc_rpo(&result, 0);
+      break;
+    case FCA_IDOMS:
+      g.calc_idoms(&result, 0);
+      break;
+    case FCA_IPDOMS:
+      {
+        fc_csr_graph_t rg;
+        g.reverse(&rg, g.nnodes);
+        rg.calc_idoms(&result, g.nnodes);
+        result.resize(g.nnodes);
+        for ( size_t i = 0; i < result.size(); ++i )
+          if ( result[i] == g.nnodes )
+            result[i] = -1;
+      }
+      break;
+    case FCA_SCCS:
+      g.calc_sccs(&result);
+      break;
+    case FCA_LOOPS:
+    case FCA_LOOPDEPTH:
+      {
+        intvec_t idoms, headers, depths;
+        g.calc_idoms(&idoms, 0);
+        g.calc_loops(&headers, &depths, idoms);
+        result.swap(what == FCA_LOOPS ? headers : depths);
+      }
+      break;
+  }
+  Py_END_ALLOW_THREADS;
+  return PyW_PackVecToPyString(result);
+}
+//</inline(py_gdl)>
+
+//<init(py_gdl)>
+#ifdef TESTABLE_BUILD
+fc_csr_graph_selftest();
+#endif
+//</init(py_gdl)>
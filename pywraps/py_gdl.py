@@ -1,5 +1,6 @@
 #<pycode(py_gdl)>
 import _ida_idaapi
+import ida_idaapi
 import types
 # -----------------------------------------------------------------------
 class BasicBlock(object):
@@ -10,32 +11,45 @@ class BasicBlock(object):
         self.id = id
         """Basic block ID"""
 
-        self.start_ea = bb.start_ea
+        a = fc._get_arrays() if bb is None else None
+
+        self.start_ea = bb.start_ea if a is None else a.starts[id]
         """start_ea of basic block"""
 
-        self.end_ea = bb.end_ea
+        self.end_ea = bb.end_ea if a is None else a.ends[id]
         """end_ea of basic block"""
 
-        self.type  = self._fc._q.calc_block_type(self.id)
-        """Block type (check fc_block_type_t enum)"""
+        self._type = None
+
+
+    def __get_type(self):
+        if self._type is None:
+            self._type = self._fc._get_arrays().types[self.id]
+        return self._type
+
+    def __set_type(self, t):
+        self._type = t
+
+    type = property(__get_type, __set_type)
+    """Block type (check fc_block_type_t enum)"""
 
 
     def preds(self):
         """
         Iterates the predecessors list
         """
-        q = self._fc._q
-        for i in xrange(0, self._fc._q.npred(self.id)):
-            yield self._fc[q.pred(self.id, i)]
+        a = self._fc._get_arrays()
+        for n in a.preds[a.pred_offsets[self.id]:a.pred_offsets[self.id+1]]:
+            yield self._fc[n]
 
 
     def succs(self):
         """
         Iterates the successors list
         """
-        q = self._fc._q
-        for i in xrange(0, q.nsucc(self.id)):
-            yield self._fc[q.succ(self.id, i)]
+        a = self._fc._get_arrays()
+        for n in a.succs[a.succ_offsets[self.id]:a.succ_offsets[self.id+1]]:
+            yield self._fc[n]
 
     try:
         if _BC695:
@@ -44,6 +58,24 @@ class BasicBlock(object):
     except:
         pass # BC695 not defined at compile-time
 
+# -----------------------------------------------------------------------
+class flowchart_arrays_t(object):
+    """
+    The results of export_flowchart(), with the packed buffers
+    turned into sequences of numbers.
+    """
+    def __init__(self, q):
+        starts, ends, types, succs, preds = export_flowchart(q)
+        ea_size = 8 if ida_idaapi.__EA64__ else 4
+        unpack = ida_idaapi.unpack_packed_array
+        self.starts = unpack(starts, ea_size)
+        self.ends = unpack(ends, ea_size)
+        self.types = unpack(types, 4, True)
+        self.succ_offsets = unpack(succs[0], 4, True)
+        self.succs = unpack(succs[1], 4, True)
+        self.pred_offsets = unpack(preds[0], 4, True)
+        self.preds = unpack(preds[1], 4, True)
+
 # -----------------------------------------------------------------------
 class FlowChart(object):
     """
@@ -65,6 +97,7 @@ class FlowChart(object):
 
         # Create the flowchart
         self._q = qflow_chart_t("", f, bounds[0], bounds[1], flags)
+        self._arrays = None
 
     size = property(lambda self: self._q.size())
     """Number of blocks in the flow chart"""
@@ -73,10 +106,17 @@ class FlowChart(object):
     def refresh(self):
         """Refreshes the flow chart"""
         self._q.refresh()
+        self._arrays = None
+
+
+    def _get_arrays(self):
+        if self._arrays is None:
+            self._arrays = flowchart_arrays_t(self._q)
+        return self._arrays
 
 
     def _getitem(self, index):
-        return BasicBlock(index, self._q[index], self)
+        return BasicBlock(index, None, self)
 
 
     def __iter__(self):
@@ -94,4 +134,32 @@ class FlowChart(object):
         else:
             return self._getitem(index)
 
+
+    def _analyze(self, what):
+        return ida_idaapi.unpack_packed_array(analyze_flowchart(self._q, what), 4, True)
+
+    def rpo(self):
+        """Returns the ids of the blocks reachable from the entry, in reverse postorder"""
+        return self._analyze(FCA_RPO)
+
+    def dominators(self):
+        """Returns the immediate dominator of each block (-1 for the entry)"""
+        return self._analyze(FCA_IDOMS)
+
+    def post_dominators(self):
+        """Returns the immediate post-dominator of each block (-1 for the exits)"""
+        return self._analyze(FCA_IPDOMS)
+
+    def sccs(self):
+        """Returns the strongly connected component number of each block"""
+        return self._analyze(FCA_SCCS)
+
+    def loops(self):
+        """
+        Returns the natural loops, as a tuple (headers, depths): the
+        header of the innermost loop holding each block (or -1), and
+        the number of loops holding each block.
+        """
+        return self._analyze(FCA_LOOPS), self._analyze(FCA_LOOPDEPTH)
+
 #</pycode(py_gdl)>
@@ -22,34 +22,104 @@ private:
     GRCODE_HAVE_CREATING_GROUP   = 0x00800000,
     GRCODE_HAVE_DELETING_GROUP   = 0x01000000,
     GRCODE_HAVE_GROUP_VISIBILITY = 0x02000000,
-  };
-  struct nodetext_cache_t
-  {
-    qstring text;
-    bgcolor_t bgcolor;
-    nodetext_cache_t(const nodetext_cache_t &rhs): text(rhs.text), bgcolor(rhs.bgcolor) {}
-    nodetext_cache_t(const char *t, bgcolor_t c): text(t), bgcolor(c) {}
-    nodetext_cache_t() {}
+    GRCODE_HAVE_GETTEXT_BATCH    = 0x04000000,
   };
 
-  class nodetext_cache_map_t: public std::map<int, nodetext_cache_t>
+  // The texts of the nodes, indexed by node id. The texts are stored
+  // back to back in large chunks that are never reallocated, so the
+  // pointers handed to IDA stay valid until the store is cleared.
+  class nodetext_store_t
   {
+    struct entry_t
+    {
+      uint32 chunk;       // BADCHUNK if the text is not known yet
+      uint32 off;
+      bgcolor_t bgcolor;
+      bool declined;      // OnGetTextBatch() returned None for this node
+    };
+    static const uint32 BADCHUNK = uint32(-1);
+    static const size_t CHUNK_SIZE = 0x10000;
+    qvector<entry_t> entries;
+    qstrvec_t chunks;
+
   public:
-    nodetext_cache_t *get(int node_id)
+    void clear()
+    {
+      entries.clear();
+      chunks.clear();
+    }
+
+    bool has(int node_id) const
+    {
+      return node_id >= 0
+          && size_t(node_id) < entries.size()
+          && entries[node_id].chunk != BADCHUNK;
+    }
+
+    const char *get(int node_id, bgcolor_t *bgcolor) const
+    {
+      if ( !has(node_id) )
+        return NULL;
+      const entry_t &e = entries[node_id];
+      if ( bgcolor != NULL )
+        *bgcolor = e.bgcolor;
+      return chunks[e.chunk].begin() + e.off;
+    }
+
+    bool declined(int node_id) const
+    {
+      return node_id >= 0
+          && size_t(node_id) < entries.size()
+          && entries[node_id].declined;
+    }
+
+    void set_declined(int node_id)
+    {
+      if ( node_id < 0 )
+        return;
+      grow(node_id);
+      entries[node_id].declined = true;
+    }
+
+    const char *add(int node_id, const char *text, bgcolor_t bgcolor = DEFCOLOR)
     {
-      iterator it = find(node_id);
-      if ( it == end() )
+      if ( node_id < 0 )
         return NULL;
-      return &it->second;
+      size_t len = qstrlen(text) + 1;
+      if ( chunks.empty() || chunks.back().capacity() < chunks.back().length() + len + 2 )
+        chunks.push_back().reserve(qmax(len + 2, CHUNK_SIZE));
+      qstring &chunk = chunks.back();
+      grow(node_id);
+      entry_t &e = entries[node_id];
+      e.chunk = uint32(chunks.size() - 1);
+      e.off = uint32(chunk.length());
+      e.bgcolor = bgcolor;
+      // qstring keeps its terminating zero: append it explicitly, and
+      // the next text goes after it
+      chunk.append(text, len - 1);
+      chunk.append('\0');
+      return chunk.begin() + e.off;
     }
-    nodetext_cache_t *add(const int node_id, const char *text, bgcolor_t bgcolor = DEFCOLOR)
+
+    void grow(int node_id)
     {
-      return &(insert(std::make_pair(node_id, nodetext_cache_t(text, bgcolor))).first->second);
+      if ( size_t(node_id) >= entries.size() )
+      {
+        entry_t none = { BADCHUNK, 0, DEFCOLOR, false };
+        entries.resize(node_id + 1, none);
+      }
+    }
+
+    // a node was deleted: the following nodes got renumbered
+    void del_node(int node_id)
+    {
+      if ( node_id >= 0 && size_t(node_id) < entries.size() )
+        entries.erase(entries.begin() + node_id);
     }
   };
 
   bool refresh_needed;
-  nodetext_cache_map_t node_cache;
+  nodetext_store_t node_cache;
 
   // instance callback
   ssize_t gr_callback(int code, va_list va);
@@ -78,9 +148,27 @@ private:
   // the nodes and edges. The nodes and edges are retrieved and passed to IDA
   void on_user_refresh(mutable_graph_t *g);
 
+  // Passes the edges held in the '_packed_edges' buffer (pairs of
+  // native int32 node ids) to IDA. Returns false if there is no such buffer.
+  bool load_packed_edges(mutable_graph_t *g, int max_nodes);
+
+  // The graph currently displayed, for incremental edits
+  mutable_graph_t *get_graph()
+  {
+    return refresh_needed || view == NULL ? NULL : get_viewer_graph(view);
+  }
+
   // Retrieves the text for user-defined graph node
   // It expects either a string or a tuple (string, bgcolor)
-  bool on_user_text(mutable_graph_t * /*g*/, int node, const char **str, bgcolor_t *bg_color);
+  bool on_user_text(mutable_graph_t *g, int node, const char **str, bgcolor_t *bg_color);
+
+  // Converts the result of OnGetText() and stores it
+  const char *cache_node_text(int node, PyObject *py_text, bgcolor_t *bg_color);
+
+  // Asks OnGetTextBatch() for the texts of up to GETTEXT_BATCH_SIZE
+  // nodes whose text is not known yet, starting at 'node'
+  void fetch_node_texts(mutable_graph_t *g, int node);
+  enum { GETTEXT_BATCH_SIZE = 4096 };
 
   // Retrieves the hint for the user-defined graph
   // Calls Python and expects a string or None
@@ -320,6 +408,68 @@ public:
     _this->jump_to_node(nid);
   }
 
+  // Incremental edits: they are applied to the displayed graph, which
+  // is not rebuilt. Update() must then be called to redo the layout.
+  // The Python side keeps '_nodes' and the edges in sync.
+  static py_graph_t *get_live(PyObject *self)
+  {
+    py_graph_t *_this = view_extract_this<py_graph_t>(self);
+    if ( _this == NULL || !pycim_lookup_info.find_by_py_view(NULL, _this) )
+      return NULL;
+    return _this;
+  }
+
+  static int AddNodes(PyObject *self, int count)
+  {
+    py_graph_t *_this = get_live(self);
+    mutable_graph_t *g = _this == NULL ? NULL : _this->get_graph();
+    if ( g == NULL || count <= 0 )
+      return -1;
+    int first = g->size();
+    for ( int i = 0; i < count; ++i )
+      g->add_node(NULL);
+    return first;
+  }
+
+  static bool DelNode(PyObject *self, int n)
+  {
+    py_graph_t *_this = get_live(self);
+    mutable_graph_t *g = _this == NULL ? NULL : _this->get_graph();
+    if ( g == NULL || n < 0 || n >= g->size() )
+      return false;
+    g->del_node(n);
+    _this->node_cache.del_node(n);
+    return true;
+  }
+
+  static bool AddEdge(PyObject *self, int src, int dst)
+  {
+    py_graph_t *_this = get_live(self);
+    mutable_graph_t *g = _this == NULL ? NULL : _this->get_graph();
+    if ( g == NULL || src < 0 || dst < 0 || src >= g->size() || dst >= g->size() )
+      return false;
+    g->add_edge(src, dst, NULL);
+    return true;
+  }
+
+  static bool DelEdge(PyObject *self, int src, int dst)
+  {
+    py_graph_t *_this = get_live(self);
+    mutable_graph_t *g = _this == NULL ? NULL : _this->get_graph();
+    return g != NULL && g->del_edge(src, dst);
+  }
+
+  static bool Update(PyObject *self)
+  {
+    py_graph_t *_this = get_live(self);
+    mutable_graph_t *g = _this == NULL ? NULL : _this->get_graph();
+    if ( g == NULL )
+      return false;
+    g->redo_layout();
+    refresh_viewer(_this->view);
+    return true;
+  }
+
   static py_graph_t *Close(PyObject *self)
   {
     TWidget *view;
@@ -380,6 +530,7 @@ void py_graph_t::collect_class_callbacks_ids(pycim_callbacks_ids_t *out)
   inherited::collect_class_callbacks_ids(out);
   out->add(S_ON_REFRESH, 0);
   out->add(S_ON_GETTEXT, 0);
+  out->add(S_ON_GETTEXT_BATCH, GRCODE_HAVE_GETTEXT_BATCH);
   out->add(S_M_EDGES, -1);
   out->add(S_M_NODES, -1);
   out->add(S_ON_HINT, GRCODE_HAVE_HINT);
@@ -425,6 +576,10 @@ void py_graph_t::on_user_refresh(mutable_graph_t *g)
         // Clear cached nodes
         node_cache.clear();
 
+        // Packed edges take precedence over the '_edges' list
+        if ( load_packed_edges(g, max_nodes) )
+          return;
+
         // Get the edges
         for ( int i=(int)PyList_Size(edges.o)-1; i >= 0; i-- )
         {
@@ -460,54 +615,125 @@ void py_graph_t::on_user_refresh(mutable_graph_t *g)
 }
 
 //-------------------------------------------------------------------------
-bool py_graph_t::on_user_text(mutable_graph_t * /*g*/, int node, const char **str, bgcolor_t *bg_color)
+bool py_graph_t::load_packed_edges(mutable_graph_t *g, int max_nodes)
 {
-  // If already cached then return the value
-  nodetext_cache_t *c = node_cache.get(node);
-  if ( c != NULL )
-  {
-    *str = c->text.c_str();
-    if ( bg_color != NULL )
-      *bg_color = c->bgcolor;
-    return true;
-  }
-
-  // Not cached, call Python
   PYW_GIL_CHECK_LOCKED_SCOPE();
-  newref_t result(PyObject_CallMethod(self.o, (char *)S_ON_GETTEXT, "i", node));
-  PyW_ShowCbErr(S_ON_GETTEXT);
-  if ( result == NULL )
+  ref_t packed(PyW_TryGetAttrString(self.o, S_M_PACKED_EDGES));
+  if ( packed == NULL || packed.o == Py_None )
+    return false;
+  const void *buf;
+  Py_ssize_t len;
+  if ( PyObject_AsReadBuffer(packed.o, &buf, &len) != 0 )
+  {
+    PyErr_Clear();
     return false;
+  }
+  const int32 *ids = (const int32 *) buf;
+  size_t nedges = size_t(len) / (2 * sizeof(int32));
+  // same order as the '_edges' list
+  for ( size_t i = nedges; i > 0; --i )
+  {
+    int src = ids[2*i-2];
+    int dst = ids[2*i-1];
+    if ( src < 0 || dst < 0 || src >= max_nodes || dst >= max_nodes )
+      continue;
+    g->add_edge(src, dst, NULL);
+  }
+  return true;
+}
 
+//-------------------------------------------------------------------------
+const char *py_graph_t::cache_node_text(int node, PyObject *py_text, bgcolor_t *bg_color)
+{
   bgcolor_t cl = bg_color == NULL ? DEFCOLOR : *bg_color;
-  const char *s;
+  const char *s = "";
 
   // User returned a string?
-  if ( PyString_Check(result.o) )
+  if ( PyString_Check(py_text) )
   {
-    s = PyString_AsString(result.o);
+    s = PyString_AsString(py_text);
     if ( s == NULL )
       s = "";
-    c = node_cache.add(node, s, cl);
   }
   // User returned a sequence of text and bgcolor
-  else if ( PySequence_Check(result.o) && PySequence_Size(result.o) == 2 )
+  else if ( PySequence_Check(py_text) && PySequence_Size(py_text) == 2 )
   {
-    newref_t py_str(PySequence_GetItem(result.o, 0));
-    newref_t py_color(PySequence_GetItem(result.o, 1));
+    newref_t py_str(PySequence_GetItem(py_text, 0));
+    newref_t py_color(PySequence_GetItem(py_text, 1));
 
     if ( py_str == NULL || !PyString_Check(py_str.o) || (s = PyString_AsString(py_str.o)) == NULL )
       s = "";
     if ( py_color != NULL && PyNumber_Check(py_color.o) )
       cl = bgcolor_t(PyLong_AsUnsignedLong(py_color.o));
+  }
+  return node_cache.add(node, s, cl);
+}
+
+//-------------------------------------------------------------------------
+void py_graph_t::fetch_node_texts(mutable_graph_t *g, int node)
+{
+  intvec_t nodes;
+  int nnodes = g->size();
+  for ( int n = node; n < nnodes && nodes.size() < GETTEXT_BATCH_SIZE; ++n )
+    if ( !node_cache.has(n) && !node_cache.declined(n) )
+      nodes.push_back(n);
+  if ( nodes.empty() )
+    return;
+
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  newref_t py_nodes(PyList_New(nodes.size()));
+  for ( size_t i = 0; i < nodes.size(); ++i )
+    PyList_SetItem(py_nodes.o, i, PyInt_FromLong(nodes[i]));
+  newref_t result(PyObject_CallMethod(self.o, (char *)S_ON_GETTEXT_BATCH, "O", py_nodes.o));
+  PyW_ShowCbErr(S_ON_GETTEXT_BATCH);
+  size_t n = 0;
+  newref_t py_fast(result != NULL && PySequence_Check(result.o)
+                 ? PySequence_Fast(result.o, "expected a sequence")
+                 : NULL);
+  if ( py_fast != NULL )
+    n = qmin(size_t(PySequence_Fast_GET_SIZE(py_fast.o)), nodes.size());
+  else
+    PyErr_Clear();
+  for ( size_t i = 0; i < n; ++i )
+  {
+    PyObject *py_text = PySequence_Fast_GET_ITEM(py_fast.o, i);
+    if ( py_text != Py_None )
+      cache_node_text(nodes[i], py_text, NULL);
+    else
+      node_cache.set_declined(nodes[i]);
+  }
+  // don't ask again for the missing texts: OnGetText() will be used
+  for ( size_t i = n; i < nodes.size(); ++i )
+    node_cache.set_declined(nodes[i]);
+}
+
+//-------------------------------------------------------------------------
+bool py_graph_t::on_user_text(mutable_graph_t *g, int node, const char **str, bgcolor_t *bg_color)
+{
+  // Not cached: ask for the texts of this node, and of the ones that follow
+  if ( !node_cache.has(node)
+    && !node_cache.declined(node)
+    && has_callback(GRCODE_HAVE_GETTEXT_BATCH) )
+    fetch_node_texts(g, node);
 
-    c = node_cache.add(node, s, cl);
+  // If already cached then return the value
+  const char *s = node_cache.get(node, bg_color);
+  if ( s != NULL )
+  {
+    *str = s;
+    return true;
   }
 
-  *str = c->text.c_str();
-  if ( bg_color != NULL )
-    *bg_color = c->bgcolor;
+  // Not cached, call Python
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  newref_t result(PyObject_CallMethod(self.o, (char *)S_ON_GETTEXT, "i", node));
+  PyW_ShowCbErr(S_ON_GETTEXT);
+  if ( result == NULL )
+    return false;
 
+  if ( cache_node_text(node, result.o, bg_color) == NULL )
+    return false;
+  *str = node_cache.get(node, bg_color);
   return true;
 }
 
@@ -707,6 +933,31 @@ void pyg_select_node(PyObject *self, int nid)
 {
   py_graph_t::SelectNode(self, nid);
 }
+
+int pyg_add_nodes(PyObject *self, int count)
+{
+  return py_graph_t::AddNodes(self, count);
+}
+
+bool pyg_del_node(PyObject *self, int nid)
+{
+  return py_graph_t::DelNode(self, nid);
+}
+
+bool pyg_add_edge(PyObject *self, int src, int dst)
+{
+  return py_graph_t::AddEdge(self, src, dst);
+}
+
+bool pyg_del_edge(PyObject *self, int src, int dst)
+{
+  return py_graph_t::DelEdge(self, src, dst);
+}
+
+bool pyg_update(PyObject *self)
+{
+  return py_graph_t::Update(self);
+}
 //</code(py_graph)>
 
 //--------------------------------------------------------------------------
@@ -715,5 +966,10 @@ void pyg_select_node(PyObject *self, int nid)
 void pyg_close(PyObject *self);
 void pyg_select_node(PyObject *self, int nid);
 bool pyg_show(PyObject *self);
+int pyg_add_nodes(PyObject *self, int count);
+bool pyg_del_node(PyObject *self, int nid);
+bool pyg_add_edge(PyObject *self, int src, int dst);
+bool pyg_del_edge(PyObject *self, int src, int dst);
+bool pyg_update(PyObject *self);
 //</inline(py_graph)>
 #endif
@@ -1,4 +1,6 @@
 #<pycode(py_graph)>
+import array
+import bisect
 import ida_idaapi
 import ida_kernwin
 try:
@@ -32,6 +34,8 @@ class GraphViewer(ida_kernwin.CustomIDAMemo):
         self._title = title
         self._nodes = []
         self._edges = []
+        self._packed_edges = None
+        self._removed_nodes = []
         self._close_open = close_open
         ida_kernwin.CustomIDAMemo.__init__(self)
         self.ui_hooks_trampoline = self.UI_Hooks_Trampoline(self)
@@ -46,12 +50,159 @@ class GraphViewer(ida_kernwin.CustomIDAMemo):
         """Creates an edge between two given node ids"""
         assert src_node < len(self._nodes), "Source node %d is out of bounds" % src_node
         assert dest_node < len(self._nodes), "Destination node %d is out of bounds" % dest_node
-        self._edges.append( (src_node, dest_node) )
+        self._compact_edges()
+        if self._packed_edges is not None:
+            # the edges were set with SetGraph()
+            self._packed_edges.append(src_node)
+            self._packed_edges.append(dest_node)
+        else:
+            self._edges.append( (src_node, dest_node) )
 
     def Clear(self):
         """Clears all the nodes and edges"""
         self._nodes = []
         self._edges = []
+        self._packed_edges = None
+        self._removed_nodes = []
+
+    def SetGraph(self, nodes, edges):
+        """
+        Sets all the nodes and edges at once. This is much faster than
+        calling AddNode() and AddEdge() for large graphs, as the edges are
+        handed over to IDA in a single buffer.
+        It is meant to be called from OnRefresh(), instead of Clear().
+
+        @param nodes: the objects associated with the nodes (node ids are
+                      their indexes), or the number of nodes
+        @param edges: an array.array('i') holding the edges as consecutive
+                      (src, dest) pairs of node ids, or a sequence of
+                      (src, dest) tuples
+        """
+        if isinstance(nodes, (int, long)):
+            nodes = range(nodes)
+        self._nodes = list(nodes)
+        self._edges = []
+        self._removed_nodes = []
+        if not isinstance(edges, array.array) or edges.itemsize != 4:
+            packed = array.array('i')
+            for src, dst in edges:
+                packed.append(src)
+                packed.append(dst)
+            edges = packed
+        self._packed_edges = edges
+
+    def _compact_edges(self):
+        """
+        Applies the pending RemoveNode() calls to the edges, in one pass:
+        the edges of the removed nodes are dropped, and the other ones
+        are renumbered.
+        """
+        if not self._removed_nodes:
+            return
+        # '_removed_nodes' holds node ids as they were when each node was
+        # removed: turn them into the (sorted) ids the edges still use
+        removed = []
+        for nid in self._removed_nodes:
+            orig = nid
+            while True:
+                n = nid + bisect.bisect_right(removed, orig)
+                if n == orig:
+                    break
+                orig = n
+            bisect.insort(removed, orig)
+        self._removed_nodes = []
+        gone = set(removed)
+        def renum(n):
+            return n - bisect.bisect_left(removed, n)
+        edges = [(renum(s), renum(d)) for s, d in self._edges_of(False)
+                 if s not in gone and d not in gone]
+        if self._packed_edges is not None:
+            self._packed_edges = array.array('i', [n for e in edges for n in e])
+        else:
+            self._edges = edges
+
+    def _edges_of(self, compact=True):
+        if compact:
+            self._compact_edges()
+        if self._packed_edges is not None:
+            e = self._packed_edges
+            return [(e[i], e[i+1]) for i in xrange(0, len(e), 2)]
+        return self._edges
+
+    def InsertNode(self, obj):
+        """
+        Adds a node to the displayed graph, without rebuilding it.
+        Call Update() once the edits are done.
+
+        @return: the new node id, or -1 if the graph is not displayed
+        """
+        nid = _ida_graph.pyg_add_nodes(self, 1)
+        if nid >= 0:
+            self._nodes.append(obj)
+        return nid
+
+    def RemoveNode(self, node_id):
+        """
+        Removes a node, and its edges, from the displayed graph, without
+        rebuilding it. The nodes that follow are renumbered.
+        Call Update() once the edits are done: the Python copy of the
+        edges is only renumbered then, once for all removals.
+
+        @return: Boolean
+        """
+        if not _ida_graph.pyg_del_node(self, node_id):
+            return False
+        del self._nodes[node_id]
+        self._removed_nodes.append(node_id)
+        return True
+
+    def InsertEdge(self, src_node, dest_node):
+        """
+        Adds an edge to the displayed graph, without rebuilding it.
+        Call Update() once the edits are done.
+
+        @return: Boolean
+        """
+        if not _ida_graph.pyg_add_edge(self, src_node, dest_node):
+            return False
+        self._compact_edges()
+        if self._packed_edges is not None:
+            self._packed_edges.append(src_node)
+            self._packed_edges.append(dest_node)
+        else:
+            self._edges.append((src_node, dest_node))
+        return True
+
+    def RemoveEdge(self, src_node, dest_node):
+        """
+        Removes an edge from the displayed graph, without rebuilding it.
+        Call Update() once the edits are done.
+
+        @return: Boolean
+        """
+        if not _ida_graph.pyg_del_edge(self, src_node, dest_node):
+            return False
+        self._compact_edges()
+        e = self._packed_edges
+        if e is not None:
+            for i in xrange(0, len(e), 2):
+                if e[i] == src_node and e[i+1] == dest_node:
+                    del e[i:i+2]
+                    break
+        else:
+            self._edges.remove((src_node, dest_node))
+        return True
+
+    def Update(self):
+        """
+        Lays out and redraws the graph after InsertNode(), RemoveNode(),
+        InsertEdge() or RemoveEdge() calls. Unlike Refresh(), it doesn't
+        call OnRefresh(), and doesn't rebuild the graph.
+
+        @return: Boolean
+        """
+        self._compact_edges()
+        return _ida_graph.pyg_update(self)
 
     def OnPopup(self, form, popup_handle):
         pass
@@ -139,6 +290,19 @@ class GraphViewer(ida_kernwin.CustomIDAMemo):
 #        """
 #        return str(self[node_id])
 #
+#    def OnGetTextBatch(self, node_ids):
+#        """
+#        Optional. Triggered when the graph viewer needs the text of a node
+#        that isn't known yet: it is given that node, and the following
+#        nodes whose text isn't known either (up to 4096 of them), so that
+#        their texts can be computed in one call.
+#        OnGetText() is called for the nodes whose text is missing or None.
+#
+#        @return: a sequence of texts, one per node id, in the same format as
+#                 the return value of OnGetText()
+#        """
+#        return [str(self[n]) for n in node_ids]
+#
 #    def OnActivate(self):
 #        """
 #        Triggered when the graph window gets the focus
@@ -144,8 +144,9 @@ struct hx_clearable_t
   hx_clearable_type_t type;
 };
 DECLARE_TYPE_AS_MOVABLE(hx_clearable_t);
+inline const void *registry_key(const hx_clearable_t &hxc) { return hxc.ptr; }
 
-typedef qvector<hx_clearable_t> hx_clearables_t;
+typedef ptr_registry_t<hx_clearable_t> hx_clearables_t;
 static hx_clearables_t python_clearables;
 void hexrays_unloading__clear_python_clearable_references(void)
 {
@@ -178,13 +179,11 @@ void hexrays_register_python_clearable_instance(
         void *ptr,
         hx_clearable_type_t type)
 {
-  for ( size_t i = 0, n = python_clearables.size(); i < n; ++i )
-    if ( python_clearables[i].ptr == ptr )
-      return;
-  hx_clearable_t &hxc = python_clearables.push_back();
+  hx_clearable_t hxc;
   hxc.ptr = ptr;
   hxc.type = type;
-  debug_hexrays_ctree("registered %p\n", hxc.ptr);
+  if ( python_clearables.add_unique(hxc) )
+    debug_hexrays_ctree("registered %p\n", hxc.ptr);
 }
 
 //-------------------------------------------------------------------------
@@ -193,16 +192,8 @@ void hexrays_register_python_clearable_instance(
 // runtime, or it will be done by the C tree itself later.
 void hexrays_deregister_python_clearable_instance(void *ptr)
 {
-  for ( size_t i = 0, n = python_clearables.size(); i < n; ++i )
-  {
-    const hx_clearable_t &hxc = python_clearables[i];
-    if ( hxc.ptr == ptr )
-    {
-      python_clearables.erase(python_clearables.begin() + i);
-      debug_hexrays_ctree("de-registered %p\n", hxc.ptr);
-      break;
-    }
-  }
+  if ( python_clearables.del(ptr) )
+    debug_hexrays_ctree("de-registered %p\n", ptr);
 }
 
 //-------------------------------------------------------------------------
@@ -210,21 +201,22 @@ void hexrays_deregister_python_clearable_instance(void *ptr)
 hx_clearable_type_t hexrays_is_registered_python_clearable_instance(
         const void *ptr)
 {
-  for ( size_t i = 0, n = python_clearables.size(); i < n; ++i )
-    if ( python_clearables[i].ptr == ptr )
-      return python_clearables[i].type;
-  return hxclr_unknown;
+  const hx_clearable_t *hxc = python_clearables.find(ptr);
+  return hxc != NULL ? hxc->type : hxclr_unknown;
 }
 #endif
 
 //-------------------------------------------------------------------------
 //
 //-------------------------------------------------------------------------
+static void dcache_on_decompiled(cfunc_t *cfunc);
 cfuncptr_t _decompile(func_t *pfn, hexrays_failure_t *hf)
 {
   try
   {
     cfuncptr_t cfunc = decompile(pfn, hf);
+    if ( cfunc != NULL )
+      dcache_on_decompiled(cfunc);
     return cfunc;
   }
   catch(...)
@@ -318,8 +310,10 @@ static ssize_t idaapi ida_hexrays_ui_notification(void *, int code, va_list va)
 }
 
 //-------------------------------------------------------------------------
+static void ida_hexrays_cache_term(void);
 static void ida_hexrays_term(void)
 {
+  ida_hexrays_cache_term();
   idapython_unhook_from_notification_point(
           HT_UI, ida_hexrays_ui_notification, NULL);
 }
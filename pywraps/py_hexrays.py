@@ -36,6 +36,32 @@ def decompile(ea, hf=None):
 
     return ptr
 
+def decompile_cached(ea, hf=None):
+    """
+    Decompile a function, unless the decompilation cache holds valid
+    results for it (see enable_decompilation_cache()).
+
+    @param ea: an address in the function, or a func_t
+    @param hf: an optional hexrays_failure_t, filled on failure
+    @return: a tuple (text, ctree), as returned by get_cached_decompilation()
+    """
+    if isinstance(ea, (int, long)):
+        func = ida_funcs.get_func(ea)
+        if not func: return
+    elif type(ea) == ida_funcs.func_t:
+        func = ea
+    else:
+        raise RuntimeError('arg 1 of decompile_cached expects either ea_t or func_t argument')
+
+    if hf is None:
+        hf = hexrays_failure_t()
+
+    res = _decompile_cached(func, hf)
+    if res is None:
+        raise DecompilationFailure(hf)
+
+    return res
+
 # ---------------------------------------------------------------------
 # stringify all string types
 #qtype.__str__ = qtype.c_str
@@ -519,6 +545,57 @@ def remove_hexrays_callback(callback):
             return 1
     return 0
 
+#-------------------------------------------------------------------------
+class ctree_arrays_t(object):
+    """
+    The ctree of a cfunc_t, as exported by cfunc_t.export_ctree() (or
+    returned by get_cached_decompilation()): every item gets an index
+    (in preorder, the body being #0), and its attributes are stored in
+    parallel arrays:
+
+        ops: the item's ctype_t (cot_... or cit_...)
+        parents, first_children, next_siblings: indexes of the linked
+                 items, -1 if none
+        eas: the item's address
+        types: index of the expression's type in 'type_names',
+               -1 for statements
+        values: the value of cot_num, the address of cot_obj, 0 otherwise
+        vars: the lvar index of cot_var, -1 otherwise
+
+    Example::
+        t = ctree_arrays_t(ida_hexrays.decompile(here()))
+        for i in xrange(len(t)):
+            if t.ops[i] == cot_call:
+                print "call at 0x%x" % t.eas[i]
+    """
+    def __init__(self, cfunc):
+        # 'cfunc' can also be an already exported tuple
+        data = cfunc if isinstance(cfunc, tuple) else cfunc.export_ctree()
+        ops, parents, first_children, next_siblings, eas, types, values, lvars, type_names = data
+        ea_size = 8 if ida_idaapi.__EA64__ else 4
+        unpack = ida_idaapi.unpack_packed_array
+        self.ops = unpack(ops, 1)
+        self.parents = unpack(parents, 4, True)
+        self.first_children = unpack(first_children, 4, True)
+        self.next_siblings = unpack(next_siblings, 4, True)
+        self.eas = unpack(eas, ea_size)
+        self.types = unpack(types, 4, True)
+        self.values = unpack(values, 8)
+        self.vars = unpack(lvars, 4, True)
+        self.type_names = type_names
+
+    def __len__(self):
+        return len(self.ops)
+
+    def children(self, idx):
+        """Returns the indexes of the operands of item #idx"""
+        out = []
+        c = self.first_children[idx]
+        while c >= 0:
+            out.append(c)
+            c = self.next_siblings[c]
+        return out
+
 #</pycode(py_hexrays)>
 
 #<pycode_BC695(py_hexrays)>
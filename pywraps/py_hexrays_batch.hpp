@@ -0,0 +1,204 @@
+
+//<code(py_hexrays_batch)>
+//-------------------------------------------------------------------------
+// Rough estimate of the memory a decompiled function occupies in the
+// decompiler's cache
+static size_t estimate_cfunc_memory(cfunc_t *cfunc, const qstring &text)
+{
+  return sizeof(cfunc_t)
+       + cfunc->treeitems.size() * sizeof(cexpr_t)
+       + cfunc->get_lvars()->size() * sizeof(lvar_t)
+       + text.length();
+}
+//</code(py_hexrays_batch)>
+
+//<inline(py_hexrays_batch)>
+//-------------------------------------------------------------------------
+/*
+#<pydoc>
+def decompile_batch(funcaddrs, sink, flags=0, max_memory=0):
+    """
+    Decompile a list of functions, in order, handing each result over
+    to 'sink' as soon as it is available.
+
+    No cfunc_t is kept alive by this function: results are delivered
+    as text (and, optionally, as flat ctree arrays).
+
+    @param funcaddrs: a list of addresses, one per function
+    @param sink: either the path of a file, which receives the
+                 pseudocode of all functions; or a callable, called as
+                 sink(ea, text, ctree, error, seconds) for each function:
+                   - text: the pseudocode, or None on failure
+                   - ctree: with DCB_CTREE, the result of
+                            cfunc_t.export_ctree(); None otherwise
+                   - error: None, or a description of the failure
+                   - seconds: the time spent on the function
+                 The callable can return True to stop.
+    @param flags: combination of DCB_... flags:
+                  DCB_USE_CACHE - use the decompilation cache (see
+                                  enable_decompilation_cache()): unchanged
+                                  functions are not decompiled again, and
+                                  new results are stored
+                  DCB_COLOR_TAGS - keep the color tags in the text
+                  DCB_CTREE - also pass the ctree arrays to 'sink'
+    @param max_memory: when the estimated size of the functions
+                       decompiled since the last flush exceeds this
+                       number of bytes, the decompiler's cache of
+                       cfuncs is cleared. 0 means no limit.
+    @return: a dictionary of statistics, or None if 'sink' is a file
+             that could not be opened or written (the batch stops at
+             the first write error):
+               'decompiled', 'cached', 'failed': numbers of functions
+               'flushes': number of times the cfunc cache was cleared
+               'seconds': total time
+               'times': packed uint32 microseconds, one per function
+               'errors': list of (ea, code, description) tuples
+               'stopped': True if 'sink' stopped the batch
+    """
+    pass
+#</pydoc>
+*/
+#define DCB_USE_CACHE  0x0001
+#define DCB_COLOR_TAGS 0x0002
+#define DCB_CTREE      0x0004
+PyObject *py_decompile_batch(
+        PyObject *funcaddrs,
+        PyObject *sink,
+        int flags=0,
+        size_t max_memory=0)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  eavec_t eas;
+  if ( !PySequence_Check(funcaddrs) || PyW_PyListToEaVec(&eas, funcaddrs) < 0 )
+  {
+    PyErr_SetString(PyExc_TypeError, "funcaddrs must be a list of addresses");
+    return NULL;
+  }
+  FILE *fp = NULL;
+  if ( PyString_Check(sink) )
+  {
+    fp = qfopen(PyString_AsString(sink), "wb");
+    if ( fp == NULL )
+      Py_RETURN_NONE;
+  }
+  else if ( !PyCallable_Check(sink) )
+  {
+    PyErr_SetString(PyExc_TypeError, "sink must be a path or a callable");
+    return NULL;
+  }
+
+  bool use_cache = (flags & DCB_USE_CACHE) != 0;
+  bool want_ctree = fp == NULL && (flags & DCB_CTREE) != 0;
+  size_t ndecompiled = 0;
+  size_t ncached = 0;
+  size_t nfailed = 0;
+  size_t nflushes = 0;
+  size_t used_memory = 0;
+  bool stopped = false;
+  bool write_failed = false;
+  uint64 start_time = get_nsec_stamp();
+  qvector<uint32> times;
+  times.reserve(eas.size());
+  newref_t py_errors(PyList_New(0));
+  qstring text;
+  qstring notag;
+  qstring error;
+  for ( size_t i = 0; i < eas.size() && !stopped && !write_failed; ++i )
+  {
+    ea_t ea = eas[i];
+    uint64 t0 = get_nsec_stamp();
+    flat_ctree_t flat;
+    text.qclear();
+    error.qclear();
+    bool ok = false;
+    func_t *pfn = get_func(ea);
+    if ( pfn == NULL )
+    {
+      error = "no function";
+      PyList_Append(py_errors.o, newref_t(Py_BuildValue("(" PY_BV_EA "is)", bvea_t(ea), 0, error.c_str())).o);
+    }
+    else if ( use_cache && dcache_lookup(&text, &flat, pfn) )
+    {
+      ok = true;
+      ++ncached;
+    }
+    else
+    {
+      hexrays_failure_t hf;
+      cfuncptr_t cfunc = _decompile(pfn, &hf);
+      if ( cfunc != NULL )
+      {
+        ok = true;
+        ++ndecompiled;
+        dcache_get_text(&text, cfunc);
+        // _decompile() already stored it if the cache is enabled
+        if ( use_cache && !dcache_enabled )
+          dcache_store(cfunc);
+        if ( want_ctree )
+          flat.build(cfunc);
+        used_memory += estimate_cfunc_memory(cfunc, text);
+      }
+      else
+      {
+        error = hf.desc();
+        PyList_Append(py_errors.o, newref_t(Py_BuildValue("(" PY_BV_EA "is)", bvea_t(ea), int(hf.code), error.c_str())).o);
+      }
+    }
+    if ( !ok )
+      ++nfailed;
+    if ( ok && (flags & DCB_COLOR_TAGS) == 0 )
+    {
+      tag_remove(&notag, text);
+      text.swap(notag);
+    }
+    uint64 elapsed = get_nsec_stamp() - t0;
+    times.push_back(uint32(qmin(elapsed / 1000, uint64(0xFFFFFFFF))));
+
+    if ( fp != NULL )
+    {
+      int code;
+      if ( ok )
+        code = qfprintf(fp, "// ----- %a -----\n%s\n\n", ea, text.c_str());
+      else
+        code = qfprintf(fp, "// ----- %a: %s -----\n\n", ea, error.c_str());
+      if ( code < 0 )
+        write_failed = true;
+    }
+    else
+    {
+      newref_t py_text(ok ? PyString_FromStringAndSize(text.c_str(), text.length()) : Py_BuildValue(""));
+      newref_t py_ctree(ok && want_ctree ? flat.to_pyobj() : Py_BuildValue(""));
+      newref_t py_error(ok ? Py_BuildValue("") : PyString_FromString(error.c_str()));
+      newref_t py_res(PyObject_CallFunction(
+                              sink, PY_BV_EA "OOOd",
+                              bvea_t(ea), py_text.o, py_ctree.o, py_error.o,
+                              elapsed / 1e9));
+      if ( PyW_ShowCbErr("decompile_batch") || PyObject_IsTrue(py_res.o) )
+        stopped = true;
+    }
+
+    if ( max_memory != 0 && used_memory > max_memory )
+    {
+      clear_cached_cfuncs();
+      used_memory = 0;
+      ++nflushes;
+    }
+  }
+  if ( fp != NULL && qfclose(fp) != 0 )
+    write_failed = true;
+  if ( write_failed )
+    Py_RETURN_NONE;
+
+  newref_t py_times(PyW_PackVecToPyString(times));
+  return Py_BuildValue(
+          "{s:n,s:n,s:n,s:n,s:d,s:O,s:O,s:O}",
+          "decompiled", Py_ssize_t(ndecompiled),
+          "cached", Py_ssize_t(ncached),
+          "failed", Py_ssize_t(nfailed),
+          "flushes", Py_ssize_t(nflushes),
+          "seconds", (get_nsec_stamp() - start_time) / 1e9,
+          "times", py_times.o,
+          "errors", py_errors.o,
+          "stopped", stopped ? Py_True : Py_False);
+}
+//</inline(py_hexrays_batch)>
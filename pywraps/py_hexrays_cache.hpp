@@ -0,0 +1,475 @@
+
+//<code(py_hexrays_cache)>
+//-------------------------------------------------------------------------
+//                   persistent decompilation cache
+//-------------------------------------------------------------------------
+// The cache lives in a netnode of the database. For each function, indexed
+// by its entry address, it holds 3 blobs:
+//   DCACHE_KEY_TAG: the key the entry was stored with (see dcache_key_t)
+//   DCACHE_TEXT_TAG: the pseudocode lines (with color tags), '\n'-separated
+//   DCACHE_CTREE_TAG: the serialized flat_ctree_t
+// Changes that can affect other functions than the one they apply to
+// (a renamed global, an edited local type...) bump a generation counter,
+// which invalidates all the entries stored before.
+#define DCACHE_NODE_NAME "$ idapython decompilation cache"
+#define DCACHE_KEY_TAG   'K'
+#define DCACHE_TEXT_TAG  'T'
+#define DCACHE_CTREE_TAG 'C'
+#define DCACHE_GEN_TAG   'G'
+
+struct dcache_key_t
+{
+  uint64 hash;
+  uint64 generation;
+};
+
+static bool dcache_enabled = false;
+static bool dcache_looked_up = false;
+static nodeidx_t dcache_idx = BADNODE;
+
+//-------------------------------------------------------------------------
+static netnode dcache_node(bool create)
+{
+  if ( !dcache_looked_up || (create && dcache_idx == BADNODE) )
+  {
+    netnode n(DCACHE_NODE_NAME, 0, create);
+    dcache_idx = n;
+    dcache_looked_up = true;
+  }
+  return netnode(dcache_idx);
+}
+
+//-------------------------------------------------------------------------
+static uint64 dcache_generation(netnode n)
+{
+  return n == BADNODE ? 0 : uint64(n.altval(0, DCACHE_GEN_TAG));
+}
+
+//-------------------------------------------------------------------------
+static void dcache_bump_generation()
+{
+  netnode n = dcache_node(false);
+  if ( n != BADNODE )
+    n.altset(0, n.altval(0, DCACHE_GEN_TAG) + 1, DCACHE_GEN_TAG);
+}
+
+//-------------------------------------------------------------------------
+static void dcache_del_entry(netnode n, ea_t func_ea)
+{
+  n.delblob(func_ea, DCACHE_KEY_TAG);
+  n.delblob(func_ea, DCACHE_TEXT_TAG);
+  n.delblob(func_ea, DCACHE_CTREE_TAG);
+}
+
+//-------------------------------------------------------------------------
+static void dcache_invalidate_func(ea_t ea)
+{
+  netnode n = dcache_node(false);
+  if ( n == BADNODE )
+    return;
+  func_t *pfn = get_func(ea);
+  if ( pfn != NULL )
+    dcache_del_entry(n, pfn->start_ea);
+}
+
+//-------------------------------------------------------------------------
+// 64-bit FNV-1a
+struct dcache_hasher_t
+{
+  uint64 h;
+  dcache_hasher_t() : h(0xCBF29CE484222325ULL) {}
+
+  void add(const void *buf, size_t size)
+  {
+    const uchar *p = (const uchar *) buf;
+    for ( size_t i = 0; i < size; ++i )
+    {
+      h ^= p[i];
+      h *= 0x100000001B3ULL;
+    }
+  }
+  void add_u64(uint64 v) { add(&v, sizeof(v)); }
+  void add_str(const qstring &s)
+  {
+    add_u64(s.length());
+    add(s.c_str(), s.length());
+  }
+  void add_type(const tinfo_t &tif)
+  {
+    qstring s;
+    tif.print(&s);
+    add_str(s);
+  }
+};
+
+//-------------------------------------------------------------------------
+// Hash what the decompilation of 'pfn' depends on locally: the bytes and
+// flags of its chunks, its type and frame, and the user annotations
+// stored by the decompiler (comments, labels, number formats, lvars...)
+static uint64 dcache_hash_func(func_t *pfn)
+{
+  dcache_hasher_t hr;
+  ea_t entry = pfn->start_ea;
+  hr.add_u64(pfn->flags);
+  hr.add_u64(pfn->frsize);
+  hr.add_u64(pfn->frregs);
+  hr.add_u64(pfn->argsize);
+
+  qstring name;
+  get_name(&name, entry);
+  hr.add_str(name);
+
+  tinfo_t tif;
+  if ( get_tinfo(&tif, entry) )
+  {
+    qtype type, fields;
+    tif.serialize(&type, &fields);
+    hr.add(type.c_str(), type.length());
+    hr.add(fields.c_str(), fields.length());
+  }
+
+  bytevec_t buf;
+  func_tail_iterator_t fti(pfn);
+  for ( bool ok = fti.first(); ok; ok = fti.next() )
+  {
+    const range_t &r = fti.chunk();
+    hr.add_u64(r.start_ea);
+    hr.add_u64(r.end_ea);
+    for ( ea_t ea = r.start_ea; ea < r.end_ea; )
+    {
+      size_t n = qmin(size_t(r.end_ea - ea), size_t(0x10000));
+      buf.resize(n);
+      get_bytes(buf.begin(), n, ea);
+      hr.add(buf.begin(), n);
+      ea += n;
+    }
+    for ( ea_t ea = r.start_ea; ea < r.end_ea; ea = next_head(ea, r.end_ea) )
+      hr.add_u64(get_flags(ea));
+  }
+
+  user_cmts_t *cmts = restore_user_cmts(entry);
+  if ( cmts != NULL )
+  {
+    for ( user_cmts_t::const_iterator p = cmts->begin(); p != cmts->end(); ++p )
+    {
+      hr.add_u64(p->first.ea);
+      hr.add_u64(p->first.itp);
+      hr.add_str(p->second);
+    }
+    user_cmts_free(cmts);
+  }
+  user_labels_t *labels = restore_user_labels(entry);
+  if ( labels != NULL )
+  {
+    for ( user_labels_t::const_iterator p = labels->begin(); p != labels->end(); ++p )
+    {
+      hr.add_u64(p->first);
+      hr.add_str(p->second);
+    }
+    user_labels_free(labels);
+  }
+  user_numforms_t *numforms = restore_user_numforms(entry);
+  if ( numforms != NULL )
+  {
+    for ( user_numforms_t::const_iterator p = numforms->begin(); p != numforms->end(); ++p )
+    {
+      hr.add_u64(p->first.ea);
+      hr.add_u64(p->first.opnum);
+      hr.add_u64(p->second.flags);
+      hr.add_u64(p->second.props);
+      hr.add_u64(p->second.serial);
+      hr.add_str(p->second.type_name);
+    }
+    user_numforms_free(numforms);
+  }
+  user_iflags_t *iflags = restore_user_iflags(entry);
+  if ( iflags != NULL )
+  {
+    for ( user_iflags_t::const_iterator p = iflags->begin(); p != iflags->end(); ++p )
+    {
+      hr.add_u64(p->first.ea);
+      hr.add_u64(p->first.op);
+      hr.add_u64(p->second);
+    }
+    user_iflags_free(iflags);
+  }
+  user_unions_t *unions = restore_user_unions(entry);
+  if ( unions != NULL )
+  {
+    for ( user_unions_t::const_iterator p = unions->begin(); p != unions->end(); ++p )
+    {
+      hr.add_u64(p->first);
+      hr.add(p->second.begin(), p->second.size() * sizeof(int));
+    }
+    user_unions_free(unions);
+  }
+  lvar_uservec_t lvinf;
+  if ( restore_user_lvar_settings(&lvinf, entry) )
+  {
+    for ( size_t i = 0; i < lvinf.lvvec.size(); ++i )
+    {
+      const lvar_saved_info_t &lv = lvinf.lvvec[i];
+      hr.add_u64(lv.ll.defea);
+      hr.add_u64(lv.ll.location.atype());
+      if ( lv.ll.location.is_stkoff() )
+        hr.add_u64(lv.ll.location.stkoff());
+      else if ( lv.ll.location.is_reg1() )
+        hr.add_u64(lv.ll.location.reg1());
+      hr.add_str(lv.name);
+      hr.add_str(lv.cmt);
+      hr.add_type(lv.type);
+      hr.add_u64(lv.size);
+      hr.add_u64(lv.flags);
+    }
+    hr.add_u64(lvinf.lmaps.size());
+    hr.add_u64(lvinf.stkoff_delta);
+    hr.add_u64(lvinf.ulv_flags);
+  }
+  return hr.h;
+}
+
+//-------------------------------------------------------------------------
+static void dcache_get_text(qstring *out, cfunc_t *cfunc)
+{
+  out->qclear();
+  const strvec_t &sv = cfunc->get_pseudocode();
+  for ( size_t i = 0; i < sv.size(); ++i )
+  {
+    if ( i > 0 )
+      out->append('\n');
+    out->append(sv[i].line);
+  }
+}
+
+//-------------------------------------------------------------------------
+// Store the decompilation results of 'cfunc', unless the entry stored
+// for the function is still valid
+static void dcache_store(cfunc_t *cfunc)
+{
+  func_t *pfn = get_func(cfunc->entry_ea);
+  if ( pfn == NULL )
+    return;
+  netnode n = dcache_node(true);
+  dcache_key_t key;
+  key.hash = dcache_hash_func(pfn);
+  key.generation = dcache_generation(n);
+
+  bytevec_t blob;
+  if ( n.getblob(&blob, pfn->start_ea, DCACHE_KEY_TAG) == sizeof(dcache_key_t) )
+  {
+    dcache_key_t stored;
+    memcpy(&stored, blob.begin(), sizeof(stored));
+    if ( stored.hash == key.hash && stored.generation == key.generation )
+      return;
+  }
+
+  qstring text;
+  dcache_get_text(&text, cfunc);
+  flat_ctree_t flat;
+  flat.build(cfunc);
+  bytevec_t ctree;
+  flat.serialize(&ctree);
+
+  n.setblob(text.c_str(), text.length(), pfn->start_ea, DCACHE_TEXT_TAG);
+  n.setblob(ctree.begin(), ctree.size(), pfn->start_ea, DCACHE_CTREE_TAG);
+  n.setblob(&key, sizeof(key), pfn->start_ea, DCACHE_KEY_TAG);
+}
+
+//-------------------------------------------------------------------------
+// Called by _decompile() for every successful decompilation
+static void dcache_on_decompiled(cfunc_t *cfunc)
+{
+  if ( dcache_enabled )
+    dcache_store(cfunc);
+}
+
+//-------------------------------------------------------------------------
+// Retrieve the results stored for 'pfn', if they are still valid
+static bool dcache_lookup(qstring *text, flat_ctree_t *flat, func_t *pfn)
+{
+  netnode n = dcache_node(false);
+  if ( n == BADNODE )
+    return false;
+  bytevec_t blob;
+  if ( n.getblob(&blob, pfn->start_ea, DCACHE_KEY_TAG) != sizeof(dcache_key_t) )
+    return false;
+  dcache_key_t key;
+  memcpy(&key, blob.begin(), sizeof(key));
+  if ( key.generation != dcache_generation(n) || key.hash != dcache_hash_func(pfn) )
+    return false;
+  if ( n.getblob(&blob, pfn->start_ea, DCACHE_CTREE_TAG) <= 0
+    || !flat->deserialize(blob.begin(), blob.end()) )
+  {
+    return false;
+  }
+  text->qclear();
+  n.getblob(text, pfn->start_ea, DCACHE_TEXT_TAG);
+  return true;
+}
+
+//-------------------------------------------------------------------------
+static PyObject *dcache_build_result(const qstring &text, const flat_ctree_t &flat)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  newref_t py_text(PyString_FromStringAndSize(text.c_str(), text.length()));
+  newref_t py_ctree(flat.to_pyobj());
+  return Py_BuildValue("(OO)", py_text.o, py_ctree.o);
+}
+
+//-------------------------------------------------------------------------
+static ssize_t idaapi dcache_on_idb_event(void *, int code, va_list va)
+{
+  if ( code == idb_event::closebase )
+  {
+    dcache_looked_up = false;
+    dcache_idx = BADNODE;
+    return 0;
+  }
+  if ( dcache_node(false) == BADNODE )
+    return 0;
+  ea_t ea1;
+  ea_t ea2;
+  switch ( classify_idb_event(&ea1, &ea2, code, va) )
+  {
+    // colors are not part of the pseudocode
+    case IDBCH_NONE:
+    case IDBCH_COLOR:
+      break;
+    case IDBCH_ITEMS:
+      {
+        func_t *pfn = get_func(ea1);
+        if ( pfn == get_func(ea2 - 1) )
+          dcache_invalidate_func(ea1);
+        else
+          dcache_bump_generation();
+      }
+      break;
+    case IDBCH_FUNC:
+      dcache_invalidate_func(ea1);
+      break;
+    case IDBCH_ALL:
+      dcache_bump_generation();
+      break;
+  }
+  return 0;
+}
+
+//-------------------------------------------------------------------------
+static void ida_hexrays_cache_term(void)
+{
+  idapython_unhook_from_notification_point(HT_IDB, dcache_on_idb_event, NULL);
+}
+//</code(py_hexrays_cache)>
+
+//<inline(py_hexrays_cache)>
+//-------------------------------------------------------------------------
+/*
+#<pydoc>
+def enable_decompilation_cache(enable=True):
+    """
+    Enable or disable the decompilation cache.
+    When enabled, every successful decompile() stores the pseudocode
+    text and a summary of the ctree (see cfunc_t.export_ctree()) in
+    the database, and decompile_cached() returns them as long as the
+    function has not changed.
+    The cache is disabled by default, but what it already holds
+    stays in the database and is kept up to date either way.
+
+    @param enable: the new state
+    @return: the previous state
+    """
+    pass
+#</pydoc>
+*/
+bool enable_decompilation_cache(bool enable=true)
+{
+  bool prev = dcache_enabled;
+  dcache_enabled = enable;
+  return prev;
+}
+
+//-------------------------------------------------------------------------
+/*
+#<pydoc>
+def get_cached_decompilation(ea):
+    """
+    Retrieve the cached decompilation results of a function, without
+    decompiling it.
+
+    @param ea: an address in the function
+    @return: a tuple (text, ctree), where 'text' holds the pseudocode
+             lines (with color tags) separated by '\\n', and 'ctree'
+             is formatted as the result of cfunc_t.export_ctree();
+             or None if nothing valid is cached.
+    """
+    pass
+#</pydoc>
+*/
+PyObject *get_cached_decompilation(ea_t ea)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  func_t *pfn = get_func(ea);
+  qstring text;
+  flat_ctree_t flat;
+  bool ok;
+  Py_BEGIN_ALLOW_THREADS;
+  ok = pfn != NULL && dcache_lookup(&text, &flat, pfn);
+  Py_END_ALLOW_THREADS;
+  if ( !ok )
+    Py_RETURN_NONE;
+  return dcache_build_result(text, flat);
+}
+
+//-------------------------------------------------------------------------
+// Like get_cached_decompilation(), but decompiles the function if
+// needed (_decompile() caches it if the cache is enabled). Returns None, and fills 'hf', on failure.
+PyObject *_decompile_cached(func_t *pfn, hexrays_failure_t *hf)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  qstring text;
+  flat_ctree_t flat;
+  if ( !dcache_lookup(&text, &flat, pfn) )
+  {
+    // the decompiler may call back into Python: keep the GIL
+    cfuncptr_t cfunc = _decompile(pfn, hf);
+    if ( cfunc == NULL )
+      Py_RETURN_NONE;
+    dcache_get_text(&text, cfunc);
+    flat.build(cfunc);
+  }
+  return dcache_build_result(text, flat);
+}
+
+//-------------------------------------------------------------------------
+/*
+#<pydoc>
+def invalidate_decompilation_cache(ea=BADADDR):
+    """
+    Drop cached decompilation results.
+
+    @param ea: an address in the function to drop, or BADADDR for all
+    """
+    pass
+#</pydoc>
+*/
+void invalidate_decompilation_cache(ea_t ea=BADADDR)
+{
+  if ( ea == BADADDR )
+  {
+    netnode n = dcache_node(false);
+    if ( n != BADNODE )
+    {
+      n.kill();
+      dcache_idx = BADNODE;
+    }
+  }
+  else
+  {
+    dcache_invalidate_func(ea);
+  }
+}
+//</inline(py_hexrays_cache)>
+
+//<init(py_hexrays_cache)>
+idapython_hook_to_notification_point(HT_IDB, dcache_on_idb_event, NULL);
+//</init(py_hexrays_cache)>
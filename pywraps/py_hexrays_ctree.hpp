@@ -0,0 +1,911 @@
+
+//<code(py_hexrays_ctree)>
+//-------------------------------------------------------------------------
+//                        ctree pattern matching
+//-------------------------------------------------------------------------
+// A compiled ctree pattern (see the ctree_matcher_t documentation for
+// the syntax). The nodes are stored in a vector, node #0 being the root.
+struct ctree_pattern_t
+{
+  enum kind_t
+  {
+    PK_ANY,       // _ or ?name: anything, including a missing operand
+    PK_ELLIPSIS,  // ...: any number of remaining operands
+    PK_OP,        // (op ...)
+    PK_OR,        // (or ...)
+  };
+  enum value_kind_t
+  {
+    PV_NONE,
+    PV_NUMBER,
+    PV_STRING,
+  };
+  struct node_t
+  {
+    kind_t kind;
+    ctype_t op;
+    int bind;             // index in 'names', or -1
+    value_kind_t vkind;   // constraint on the number/var/object/string
+    uint64 value;
+    bool negative;
+    qstring str;
+    intvec_t children;
+    node_t()
+      : kind(PK_ANY), op(cot_empty), bind(-1),
+        vkind(PV_NONE), value(0), negative(false) {}
+  };
+  qvector<node_t> nodes;
+  qstrvec_t names;
+  qstring errbuf;
+
+  bool compile(const char *pattern);
+  bool match(const citem_t *item, qvector<const citem_t *> *binds) const;
+
+private:
+  const char *ptr;
+
+  bool error(const char *format, ...);
+  bool next_token(qstring *out, bool *is_string);
+  bool peek_char(char *c);
+  int parse(void);
+  int parse_after(const qstring &tok, bool is_string);
+  int add_bind(const char *name);
+  bool parse_value(node_t *n, const qstring &tok, bool is_string);
+  bool match_node(int idx, const citem_t *item, qvector<const citem_t *> *binds) const;
+  bool match_value(const node_t &n, const citem_t *item) const;
+};
+DECLARE_TYPE_AS_MOVABLE(ctree_pattern_t::node_t);
+
+//-------------------------------------------------------------------------
+static bool find_ctype_by_name(ctype_t *out, const char *name)
+{
+  for ( int op = cot_empty; op <= cit_end; ++op )
+  {
+    const char *n = get_ctype_name(ctype_t(op));
+    if ( n == NULL )
+      continue;
+    if ( strneq(n, "cot_", 4) || strneq(n, "cit_", 4) )
+      n += 4;
+    const char *s = name;
+    if ( strneq(s, "cot_", 4) || strneq(s, "cit_", 4) )
+      s += 4;
+    if ( streq(n, s) )
+    {
+      *out = ctype_t(op);
+      return true;
+    }
+  }
+  return false;
+}
+
+//-------------------------------------------------------------------------
+// The operands of an item, in pattern order (NULL for missing ones)
+static void get_ctree_operands(qvector<const citem_t *> *out, const citem_t *item)
+{
+  out->qclear();
+  if ( item->is_expr() )
+  {
+    const cexpr_t *e = (const cexpr_t *) item;
+    if ( e->op == cot_call )
+    {
+      out->push_back(e->x);
+      for ( size_t i = 0; i < e->a->size(); ++i )
+        out->push_back(&e->a->at(i));
+      return;
+    }
+    if ( op_uses_x(e->op) )
+      out->push_back(e->x);
+    if ( op_uses_y(e->op) )
+      out->push_back(e->y);
+    if ( op_uses_z(e->op) )
+      out->push_back(e->z);
+    return;
+  }
+  const cinsn_t *i = (const cinsn_t *) item;
+  switch ( i->op )
+  {
+    case cit_block:
+      for ( cblock_t::const_iterator p = i->cblock->begin(); p != i->cblock->end(); ++p )
+        out->push_back(&*p);
+      break;
+    case cit_expr:
+      out->push_back(i->cexpr);
+      break;
+    case cit_if:
+      out->push_back(&i->cif->expr);
+      out->push_back(i->cif->ithen);
+      out->push_back(i->cif->ielse);
+      break;
+    case cit_for:
+      out->push_back(&i->cfor->init);
+      out->push_back(&i->cfor->expr);
+      out->push_back(&i->cfor->step);
+      out->push_back(i->cfor->body);
+      break;
+    case cit_while:
+      out->push_back(&i->cwhile->expr);
+      out->push_back(i->cwhile->body);
+      break;
+    case cit_do:
+      out->push_back(i->cdo->body);
+      out->push_back(&i->cdo->expr);
+      break;
+    case cit_switch:
+      out->push_back(&i->cswitch->expr);
+      break;
+    case cit_return:
+      out->push_back(&i->creturn->expr);
+      break;
+    default:
+      break;
+  }
+}
+
+//-------------------------------------------------------------------------
+bool ctree_pattern_t::error(const char *format, ...)
+{
+  if ( errbuf.empty() )
+  {
+    va_list va;
+    va_start(va, format);
+    errbuf.vsprnt(format, va);
+    va_end(va);
+  }
+  return false;
+}
+
+//-------------------------------------------------------------------------
+bool ctree_pattern_t::peek_char(char *c)
+{
+  while ( qisspace(*ptr) )
+    ptr++;
+  *c = *ptr;
+  return *ptr != '\0';
+}
+
+//-------------------------------------------------------------------------
+bool ctree_pattern_t::next_token(qstring *out, bool *is_string)
+{
+  out->qclear();
+  *is_string = false;
+  char c;
+  if ( !peek_char(&c) )
+    return false;
+  if ( c == '(' || c == ')' )
+  {
+    out->append(c);
+    ptr++;
+    return true;
+  }
+  if ( c == '"' )
+  {
+    *is_string = true;
+    for ( ptr++; *ptr != '"'; ptr++ )
+    {
+      if ( *ptr == '\0' )
+        return error("unterminated string");
+      if ( *ptr == '\\' && ptr[1] != '\0' )
+        ptr++;
+      out->append(*ptr);
+    }
+    ptr++;
+    return true;
+  }
+  while ( *ptr != '\0' && !qisspace(*ptr) && *ptr != '(' && *ptr != ')' && *ptr != '"' )
+    out->append(*ptr++);
+  return true;
+}
+
+//-------------------------------------------------------------------------
+int ctree_pattern_t::add_bind(const char *name)
+{
+  for ( size_t i = 0; i < names.size(); ++i )
+    if ( names[i] == name )
+      return int(i);
+  names.push_back(name);
+  return int(names.size() - 1);
+}
+
+//-------------------------------------------------------------------------
+int ctree_pattern_t::parse(void)
+{
+  qstring tok;
+  bool is_string;
+  if ( !next_token(&tok, &is_string) )
+  {
+    error("unexpected end of pattern");
+    return -1;
+  }
+  return parse_after(tok, is_string);
+}
+
+//-------------------------------------------------------------------------
+bool ctree_pattern_t::parse_value(node_t *n, const qstring &tok, bool is_string)
+{
+  if ( is_string )
+  {
+    n->vkind = PV_STRING;
+    n->str = tok;
+    return true;
+  }
+  const char *s = tok.c_str();
+  n->negative = *s == '-';
+  if ( n->negative )
+    s++;
+  char *end;
+  n->value = strtoull(s, &end, 0);
+  if ( *s == '\0' || *end != '\0' )
+    return error("bad value: %s", tok.c_str());
+  if ( n->negative )
+    n->value = uint64(-int64(n->value));
+  n->vkind = PV_NUMBER;
+  return true;
+}
+
+//-------------------------------------------------------------------------
+// Parse a pattern whose first token is 'tok'
+int ctree_pattern_t::parse_after(const qstring &tok, bool is_string)
+{
+  int idx = int(nodes.size());
+  nodes.push_back();
+  if ( is_string )
+  {
+    error("unexpected string: \"%s\"", tok.c_str());
+    return -1;
+  }
+  if ( tok == "_" )
+    return idx;
+  if ( tok == "..." )
+  {
+    nodes[idx].kind = PK_ELLIPSIS;
+    return idx;
+  }
+  if ( tok[0] == '?' )
+  {
+    // ?name, or ?name:pattern
+    qstring name = tok.substr(1);
+    qstring rest;
+    size_t colon = name.find(':');
+    bool constrained = colon != qstring::npos;
+    if ( constrained )
+    {
+      rest = name.substr(colon + 1);
+      name.resize(colon);
+    }
+    if ( name.empty() )
+    {
+      error("missing name after '?'");
+      return -1;
+    }
+    int bind = add_bind(name.c_str());
+    if ( !constrained )
+    {
+      nodes[idx].bind = bind;
+      return idx;
+    }
+    nodes.pop_back();
+    int sub = rest.empty() ? parse() : parse_after(rest, false);
+    if ( sub >= 0 )
+    {
+      if ( nodes[sub].bind >= 0 )
+      {
+        error("'%s' is bound twice", name.c_str());
+        return -1;
+      }
+      nodes[sub].bind = bind;
+    }
+    return sub;
+  }
+  if ( tok != "(" )
+  {
+    error("unexpected token: %s", tok.c_str());
+    return -1;
+  }
+
+  qstring opname;
+  bool opstr;
+  if ( !next_token(&opname, &opstr) || opstr || opname == "(" || opname == ")" )
+  {
+    error("expected an operator name after '('");
+    return -1;
+  }
+  if ( opname == "or" )
+  {
+    nodes[idx].kind = PK_OR;
+  }
+  else
+  {
+    ctype_t op;
+    if ( !find_ctype_by_name(&op, opname.c_str()) )
+    {
+      error("unknown operator: %s", opname.c_str());
+      return -1;
+    }
+    nodes[idx].kind = PK_OP;
+    nodes[idx].op = op;
+  }
+
+  // leaves take one optional value constraint, which may be a binding
+  bool leaf = false;
+  switch ( nodes[idx].op )
+  {
+    case cot_num:
+    case cot_obj:
+    case cot_var:
+    case cot_str:
+    case cot_helper:
+      leaf = nodes[idx].kind == PK_OP;
+      break;
+    default:
+      break;
+  }
+  while ( true )
+  {
+    qstring t;
+    bool t_str;
+    if ( !next_token(&t, &t_str) )
+    {
+      error("missing ')'");
+      return -1;
+    }
+    if ( !t_str && t == ")" )
+      break;
+    if ( leaf )
+    {
+      if ( !t_str && t == "_" )
+        continue;
+      if ( !t_str && t[0] == '?' )
+      {
+        nodes[idx].bind = add_bind(t.c_str() + 1);
+        continue;
+      }
+      if ( nodes[idx].vkind != PV_NONE )
+      {
+        error("too many values for %s", opname.c_str());
+        return -1;
+      }
+      if ( !parse_value(&nodes[idx], t, t_str) )
+        return -1;
+      continue;
+    }
+    if ( !nodes[idx].children.empty()
+      && nodes[nodes[idx].children.back()].kind == PK_ELLIPSIS )
+    {
+      error("'...' must be the last operand");
+      return -1;
+    }
+    int child = parse_after(t, t_str);
+    if ( child < 0 )
+      return -1;
+    nodes[idx].children.push_back(child);
+  }
+  return idx;
+}
+
+//-------------------------------------------------------------------------
+bool ctree_pattern_t::compile(const char *pattern)
+{
+  nodes.clear();
+  names.clear();
+  errbuf.qclear();
+  ptr = pattern;
+  int root = parse();
+  if ( root < 0 )
+    return false;
+  char c;
+  if ( peek_char(&c) )
+    return error("unexpected text after the pattern: %s", ptr);
+  // the root must be node #0
+  QASSERT(30620, root == 0);
+  return true;
+}
+
+//-------------------------------------------------------------------------
+bool ctree_pattern_t::match_value(const node_t &n, const citem_t *item) const
+{
+  if ( n.vkind == PV_NONE )
+    return true;
+  const cexpr_t *e = (const cexpr_t *) item;
+  switch ( e->op )
+  {
+    case cot_num:
+      if ( n.vkind != PV_NUMBER )
+        return false;
+      if ( n.negative )
+        return e->n->value(e->type) == n.value;
+      return e->numval() == n.value;
+    case cot_var:
+      return n.vkind == PV_NUMBER && uint64(e->v.idx) == n.value;
+    case cot_obj:
+      if ( n.vkind == PV_NUMBER )
+        return uint64(e->obj_ea) == n.value;
+      {
+        qstring name;
+        return get_name(&name, e->obj_ea) > 0 && name == n.str;
+      }
+    case cot_str:
+      return n.vkind == PV_STRING && e->string != NULL && n.str == e->string;
+    case cot_helper:
+      return n.vkind == PV_STRING && e->helper != NULL && n.str == e->helper;
+    default:
+      return false;
+  }
+}
+
+//-------------------------------------------------------------------------
+bool ctree_pattern_t::match_node(
+        int idx,
+        const citem_t *item,
+        qvector<const citem_t *> *binds) const
+{
+  const node_t &n = nodes[idx];
+  switch ( n.kind )
+  {
+    case PK_ANY:
+    case PK_ELLIPSIS:
+      break;
+    case PK_OR:
+      for ( size_t i = 0; i < n.children.size(); ++i )
+      {
+        qvector<const citem_t *> saved = *binds;
+        if ( match_node(n.children[i], item, binds) )
+          goto MATCHED;
+        binds->swap(saved);
+      }
+      return false;
+    case PK_OP:
+      {
+        if ( item == NULL || item->op != n.op || !match_value(n, item) )
+          return false;
+        qvector<const citem_t *> ops;
+        get_ctree_operands(&ops, item);
+        size_t npat = n.children.size();
+        bool ellipsis = npat > 0 && nodes[n.children.back()].kind == PK_ELLIPSIS;
+        if ( ellipsis )
+          npat--;
+        // calls and blocks have a variable number of operands: without
+        // '...', the number of operands must match
+        bool variadic = n.op == cot_call || n.op == cit_block;
+        if ( npat > ops.size() || (variadic && !ellipsis && npat != ops.size()) )
+          return false;
+        for ( size_t i = 0; i < npat; ++i )
+          if ( !match_node(n.children[i], ops[i], binds) )
+            return false;
+      }
+      break;
+  }
+MATCHED:
+  if ( n.bind >= 0 )
+  {
+    const citem_t *&b = binds->at(n.bind);
+    // a name bound several times must denote equal sub-trees
+    if ( b != NULL && b != item )
+    {
+      if ( item == NULL || !b->is_expr() || !item->is_expr()
+        || !((const cexpr_t *) b)->equal_effect(*(const cexpr_t *) item) )
+      {
+        return false;
+      }
+    }
+    b = item;
+  }
+  return true;
+}
+
+//-------------------------------------------------------------------------
+bool ctree_pattern_t::match(const citem_t *item, qvector<const citem_t *> *binds) const
+{
+  binds->clear();
+  binds->resize(names.size(), NULL);
+  return match_node(0, item, binds);
+}
+
+//-------------------------------------------------------------------------
+static PyObject *citem_to_pyobj(const citem_t *item)
+{
+  if ( item == NULL )
+    Py_RETURN_NONE;
+  if ( item->is_expr() )
+    return SWIG_NewPointerObj(SWIG_as_voidptr(item), SWIGTYPE_p_cexpr_t, 0);
+  return SWIG_NewPointerObj(SWIG_as_voidptr(item), SWIGTYPE_p_cinsn_t, 0);
+}
+
+//-------------------------------------------------------------------------
+// Walks a ctree and reports the items matching a pattern
+struct ctree_pattern_visitor_t : public ctree_visitor_t
+{
+  const ctree_pattern_t &pat;
+  PyObject *callback;
+  qvector<const citem_t *> binds;
+  size_t nmatches;
+  bool failed;
+
+  ctree_pattern_visitor_t(const ctree_pattern_t &_pat, PyObject *_callback)
+    : ctree_visitor_t(CV_FAST), pat(_pat), callback(_callback),
+      nmatches(0), failed(false) {}
+
+  int visit_item(const citem_t *item)
+  {
+    if ( !pat.match(item, &binds) )
+      return 0;
+    nmatches++;
+    if ( callback == NULL )
+      return 0;
+
+    PYW_GIL_CHECK_LOCKED_SCOPE();
+    newref_t py_binds(PyDict_New());
+    for ( size_t i = 0; i < binds.size(); ++i )
+    {
+      newref_t py_item(citem_to_pyobj(binds[i]));
+      PyDict_SetItemString(py_binds.o, pat.names[i].c_str(), py_item.o);
+    }
+    newref_t py_item(citem_to_pyobj(item));
+    newref_t py_result(
+            PyObject_CallFunctionObjArgs(
+                    callback,
+                    py_item.o,
+                    py_binds.o,
+                    NULL));
+    if ( PyW_ShowCbErr("ctree_matcher_t") || py_result == NULL )
+    {
+      failed = true;
+      return 1;
+    }
+    // a true result stops the walk
+    return PyObject_IsTrue(py_result.o) ? 1 : 0;
+  }
+
+  int idaapi visit_insn(cinsn_t *i) { return visit_item(i); }
+  int idaapi visit_expr(cexpr_t *e) { return visit_item(e); }
+};
+//-------------------------------------------------------------------------
+//                        flat ctree export
+//-------------------------------------------------------------------------
+// The items of a ctree, numbered in preorder, as parallel arrays
+// (see the cfunc_t.export_ctree() documentation)
+struct flat_ctree_t
+{
+  bytevec_t ops;
+  intvec_t parents;
+  intvec_t first_children;
+  intvec_t next_siblings;
+  eavec_t eas;
+  intvec_t types;
+  qvector<uint64> values;
+  intvec_t vars;
+  qstrvec_t type_names;
+
+  void build(const cfunc_t *cfunc);
+  void serialize(bytevec_t *out) const;
+  bool deserialize(const uchar *ptr, const uchar *end);
+  PyObject *to_pyobj() const;
+};
+
+//-------------------------------------------------------------------------
+// Walk the ctree of 'cfunc' once
+void flat_ctree_t::build(const cfunc_t *cfunc)
+{
+  // types are interned by their serialized form, and only printed once
+  typedef std::map<std::pair<qstring, qstring>, int> type_bytes_ids_t;
+  type_bytes_ids_t type_bytes_ids;
+  std::map<qstring, int> type_ids;
+  qtype ttype, tfields;
+  std::pair<qstring, qstring> tbytes;
+  struct pending_t
+  {
+    const citem_t *item;
+    int parent;
+  };
+  qvector<pending_t> stack;
+  qvector<const citem_t *> operands;
+  intvec_t last_children; // last child seen so far, for every item
+  pending_t root = { &cfunc->body, -1 };
+  stack.push_back(root);
+  while ( !stack.empty() )
+  {
+    pending_t cur = stack.back();
+    stack.pop_back();
+    const citem_t *item = cur.item;
+    int id = int(ops.size());
+    ops.push_back(uchar(item->op));
+    parents.push_back(cur.parent);
+    first_children.push_back(-1);
+    next_siblings.push_back(-1);
+    eas.push_back(item->ea);
+    last_children.push_back(-1);
+    if ( cur.parent >= 0 )
+    {
+      int prev = last_children[cur.parent];
+      if ( prev >= 0 )
+        next_siblings[prev] = id;
+      else
+        first_children[cur.parent] = id;
+      last_children[cur.parent] = id;
+    }
+
+    int type = -1;
+    uint64 value = 0;
+    int var = -1;
+    if ( item->is_expr() )
+    {
+      const cexpr_t *e = (const cexpr_t *) item;
+      type_bytes_ids_t::iterator pb = type_bytes_ids.end();
+      ttype.qclear();
+      tfields.qclear();
+      bool serialized = e->type.serialize(&ttype, &tfields, NULL, SUDT_FAST);
+      if ( serialized )
+      {
+        tbytes.first = (const char *) ttype.c_str();
+        tbytes.second = (const char *) tfields.c_str();
+        pb = type_bytes_ids.find(tbytes);
+      }
+      if ( pb != type_bytes_ids.end() )
+      {
+        type = pb->second;
+      }
+      else
+      {
+        qstring tname;
+        if ( e->type.print(&tname) )
+        {
+          std::map<qstring, int>::iterator p = type_ids.find(tname);
+          if ( p == type_ids.end() )
+          {
+            p = type_ids.insert(std::make_pair(tname, int(type_names.size()))).first;
+            type_names.push_back(tname);
+          }
+          type = p->second;
+        }
+        if ( serialized )
+          type_bytes_ids.insert(std::make_pair(tbytes, type));
+      }
+      if ( e->op == cot_num )
+        value = e->numval();
+      else if ( e->op == cot_obj )
+        value = e->obj_ea;
+      else if ( e->op == cot_var )
+        var = e->v.idx;
+    }
+    types.push_back(type);
+    values.push_back(value);
+    vars.push_back(var);
+
+    // push the operands in reverse, so that they are numbered in order
+    get_ctree_operands(&operands, item);
+    size_t n = 0;
+    for ( size_t i = 0; i < operands.size(); ++i )
+      if ( operands[i] != NULL )
+        operands[n++] = operands[i];
+    operands.resize(n);
+    for ( size_t i = n; i > 0; --i )
+    {
+      pending_t child = { operands[i-1], id };
+      stack.push_back(child);
+    }
+  }
+}
+
+//-------------------------------------------------------------------------
+// The serialized form is: the number of items and of type names (uint32),
+// the arrays, and the type names (uint32 length + characters), all in the
+// native byte order.
+template <class T>
+static void append_flat_array(bytevec_t *out, const qvector<T> &v)
+{
+  if ( !v.empty() )
+    out->append(v.begin(), v.size() * sizeof(T));
+}
+
+template <class T>
+static bool extract_flat_array(qvector<T> *v, size_t n, const uchar **pptr, const uchar *end)
+{
+  size_t sz = n * sizeof(T);
+  if ( size_t(end - *pptr) < sz )
+    return false;
+  v->resize(n);
+  if ( sz != 0 )
+    memcpy(v->begin(), *pptr, sz);
+  *pptr += sz;
+  return true;
+}
+
+static bool extract_flat_uint32(uint32 *out, const uchar **pptr, const uchar *end)
+{
+  if ( size_t(end - *pptr) < sizeof(uint32) )
+    return false;
+  memcpy(out, *pptr, sizeof(uint32));
+  *pptr += sizeof(uint32);
+  return true;
+}
+
+void flat_ctree_t::serialize(bytevec_t *out) const
+{
+  uint32 counts[2] = { uint32(ops.size()), uint32(type_names.size()) };
+  out->append(counts, sizeof(counts));
+  append_flat_array(out, ops);
+  append_flat_array(out, parents);
+  append_flat_array(out, first_children);
+  append_flat_array(out, next_siblings);
+  append_flat_array(out, eas);
+  append_flat_array(out, types);
+  append_flat_array(out, values);
+  append_flat_array(out, vars);
+  for ( size_t i = 0; i < type_names.size(); ++i )
+  {
+    uint32 len = uint32(type_names[i].length());
+    out->append(&len, sizeof(len));
+    out->append(type_names[i].c_str(), len);
+  }
+}
+
+bool flat_ctree_t::deserialize(const uchar *ptr, const uchar *end)
+{
+  uint32 n, ntypes;
+  if ( !extract_flat_uint32(&n, &ptr, end)
+    || !extract_flat_uint32(&ntypes, &ptr, end)
+    || !extract_flat_array(&ops, n, &ptr, end)
+    || !extract_flat_array(&parents, n, &ptr, end)
+    || !extract_flat_array(&first_children, n, &ptr, end)
+    || !extract_flat_array(&next_siblings, n, &ptr, end)
+    || !extract_flat_array(&eas, n, &ptr, end)
+    || !extract_flat_array(&types, n, &ptr, end)
+    || !extract_flat_array(&values, n, &ptr, end)
+    || !extract_flat_array(&vars, n, &ptr, end) )
+  {
+    return false;
+  }
+  type_names.resize(ntypes);
+  for ( uint32 i = 0; i < ntypes; ++i )
+  {
+    uint32 len;
+    if ( !extract_flat_uint32(&len, &ptr, end) || size_t(end - ptr) < len )
+      return false;
+    type_names[i].qclear();
+    type_names[i].append((const char *) ptr, len);
+    ptr += len;
+  }
+  return ptr == end;
+}
+
+//-------------------------------------------------------------------------
+PyObject *flat_ctree_t::to_pyobj() const
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  newref_t py_ops(PyW_PackVecToPyString(ops));
+  newref_t py_parents(PyW_PackVecToPyString(parents));
+  newref_t py_first_children(PyW_PackVecToPyString(first_children));
+  newref_t py_next_siblings(PyW_PackVecToPyString(next_siblings));
+  newref_t py_eas(PyW_PackVecToPyString(eas));
+  newref_t py_types(PyW_PackVecToPyString(types));
+  newref_t py_values(PyW_PackVecToPyString(values));
+  newref_t py_vars(PyW_PackVecToPyString(vars));
+  newref_t py_type_names(PyList_New(type_names.size()));
+  for ( size_t i = 0; i < type_names.size(); ++i )
+    PyList_SetItem(py_type_names.o, i, PyString_FromString(type_names[i].c_str()));
+  return Py_BuildValue("(OOOOOOOOO)",
+                       py_ops.o, py_parents.o, py_first_children.o,
+                       py_next_siblings.o, py_eas.o, py_types.o,
+                       py_values.o, py_vars.o, py_type_names.o);
+}
+
+//-------------------------------------------------------------------------
+static PyObject *export_cfunc_ctree(const cfunc_t *cfunc)
+{
+  flat_ctree_t flat;
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  Py_BEGIN_ALLOW_THREADS;
+  flat.build(cfunc);
+  Py_END_ALLOW_THREADS;
+  return flat.to_pyobj();
+}
+
+//</code(py_hexrays_ctree)>
+
+//<inline(py_hexrays_ctree)>
+//-------------------------------------------------------------------------
+/*
+#<pydoc>
+class ctree_matcher_t(object):
+    """
+    A compiled ctree pattern. Matching it against the ctree of a function
+    (see cfunc_t.match_ctree()) happens natively: Python is only called
+    for the matching items.
+
+    Patterns are s-expressions:
+
+      _                 anything (also matches a missing operand)
+      ?name             anything, bound to 'name'
+      ?name:pattern     'pattern', bound to 'name'
+      (op p1 p2 ...)    an item of type 'op' (a cot_... or cit_... name,
+                        with or without the prefix), whose operands match
+                        p1, p2, ... Missing trailing patterns match anything,
+                        except for calls and blocks, where '...' must end
+                        the list to allow more operands.
+      ...               the remaining operands, if any
+      (or p1 p2 ...)    any of the patterns
+
+    The operands are:
+      - for calls: the callee, then the arguments
+      - for other expressions: x, y, z (as used by the operator)
+      - if: condition, then, else. for: init, condition, step, body.
+        while: condition, body. do: body, condition.
+        switch, return, expr: the expression. block: the statements
+
+    num, var, obj, str and helper take an optional value: a number (the
+    constant value, the local variable index, or the object address),
+    or a string (the object name, the string contents, or the helper
+    name). A '?name' instead binds the leaf itself.
+    A name used several times must denote equal expressions.
+
+    Example: a call to memcpy with a constant size, binding the size:
+      (call (obj "memcpy") _ _ (num ?size))
+    """
+    def __init__(self, pattern):
+        """
+        Compile 'pattern'. Check ok() and error() afterwards.
+        """
+        pass
+    def ok(self):
+        """Returns whether the pattern compiled"""
+        pass
+    def error(self):
+        """Returns the compilation error message"""
+        pass
+    def names(self):
+        """Returns the list of bound names"""
+        pass
+    def apply(self, item, callback=None):
+        """
+        Match 'item' and its descendants.
+        @param callback: called as callback(item, bindings) for each
+                         matching item, where 'bindings' maps the bound
+                         names to their cexpr_t/cinsn_t (or None).
+                         These objects are only valid as long as the
+                         ctree is. Return True to stop.
+        @return: the number of matches, or -1 on failure
+        """
+        pass
+#</pydoc>
+*/
+class ctree_matcher_t
+{
+  ctree_pattern_t pat;
+  bool compiled;
+
+public:
+  ctree_matcher_t(const char *pattern)
+  {
+    compiled = pat.compile(pattern);
+  }
+
+  bool ok() const { return compiled; }
+  const char *error() const { return pat.errbuf.c_str(); }
+
+  PyObject *names() const
+  {
+    PYW_GIL_CHECK_LOCKED_SCOPE();
+    newref_t py_names(PyList_New(pat.names.size()));
+    for ( size_t i = 0; i < pat.names.size(); ++i )
+      PyList_SetItem(py_names.o, i, PyString_FromString(pat.names[i].c_str()));
+    py_names.incref();
+    return py_names.o;
+  }
+
+  // Match 'root' and its descendants. 'callback(item, bindings)' is
+  // called for each match; it returns True to stop.
+  // Returns the number of matches, or -1 if the pattern is invalid or
+  // the callback failed.
+  ssize_t apply(citem_t *root, PyObject *callback=NULL)
+  {
+    if ( !compiled )
+      return -1;
+    PyObject *cb = callback == NULL || callback == Py_None ? NULL : callback;
+    ctree_pattern_visitor_t v(pat, cb);
+    if ( root->is_expr() )
+      v.apply_to_exprs(root, NULL);
+    else
+      v.apply_to(root, NULL);
+    return v.failed ? -1 : ssize_t(v.nmatches);
+  }
+};
+//</inline(py_hexrays_ctree)>
@@ -605,6 +605,31 @@ def _listify_types(*classes):
         cls.__len__ = cls.size
         cls.__iter__ = _bounded_getitem_iterator
 
+# -----------------------------------------------------------------------
+import array
+def unpack_packed_array(buf, itemsize, signed=False):
+    """
+    Turns a 'str' holding native-endian integers of 'itemsize' bytes
+    each (such as the buffers returned by the various bulk exporters),
+    into a sequence of numbers.
+
+    @param buf: the packed data
+    @param itemsize: size of one item, in bytes (1, 2, 4 or 8)
+    @param signed: whether the items are signed
+    @return: an 'array.array' if there is a matching array typecode,
+             a tuple otherwise.
+    """
+    for tc in ("bhilq" if signed else "BHILQ"):
+        try:
+            if array.array(tc).itemsize == itemsize:
+                return array.array(tc, buf)
+        except ValueError: # typecode not supported by this Python
+            pass
+    fmt = {1 : "b", 2 : "h", 4 : "i", 8 : "q"}[itemsize]
+    if not signed:
+        fmt = fmt.upper()
+    return struct.unpack("=%d%s" % (len(buf) / itemsize, fmt), buf)
+
 # The general callback format of notify_when() is:
 #    def notify_when_callback(nw_code)
 # In the case of NW_OPENIDB, the callback is:
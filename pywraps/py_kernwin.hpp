@@ -14,6 +14,121 @@ struct py_idchotkey_ctx_t
   PyObject *pyfunc;
 };
 
+//-------------------------------------------------------------------------
+// Background writer used by export_listing(): the listing is rendered
+// on the calling thread (the kernel is not thread-safe), while the
+// rendered buffers are written to the file by this thread. At most
+// 'maxq' buffers can be queued, which bounds the memory use.
+struct listing_writer_t
+{
+  FILE *fp;
+  qmutex_t lock;
+  qsemaphore_t filled;     // one post per queued buffer, plus one to stop
+  qsemaphore_t free_slots; // one post per buffer that can still be queued
+  qstrvec_t queue;
+  uint64 written;
+  bool failed;
+  qthread_t thread;
+
+  static int idaapi thread_cb(void *ud)
+  {
+    listing_writer_t *w = (listing_writer_t *) ud;
+    while ( true )
+    {
+      qsem_wait(w->filled, -1);
+      qstring buf;
+      qmutex_lock(w->lock);
+      bool stop = w->queue.empty();
+      if ( !stop )
+      {
+        buf.swap(w->queue.front());
+        w->queue.erase(w->queue.begin());
+      }
+      qmutex_unlock(w->lock);
+      if ( stop )
+        break;
+      size_t len = buf.length();
+      bool ok = qfwrite(w->fp, buf.c_str(), len) == len;
+      qmutex_lock(w->lock);
+      if ( ok )
+        w->written += len;
+      else
+        w->failed = true;
+      qmutex_unlock(w->lock);
+      qsem_post(w->free_slots);
+    }
+    return 0;
+  }
+
+  listing_writer_t(FILE *_fp, int maxq)
+    : fp(_fp), written(0), failed(false)
+  {
+    lock = qmutex_create();
+    filled = qsem_create(NULL, 0);
+    free_slots = qsem_create(NULL, maxq);
+    thread = qthread_create(thread_cb, this);
+    if ( thread == NULL )
+      failed = true;
+  }
+
+  ~listing_writer_t()
+  {
+    finish();
+    qsem_free(free_slots);
+    qsem_free(filled);
+    qmutex_free(lock);
+  }
+
+  // Hand 'buf' over to the writer thread; 'buf' is left empty.
+  // Blocks while the queue is full.
+  void push(qstring *buf)
+  {
+    if ( thread == NULL )
+    {
+      buf->qclear();
+      return;
+    }
+    qsem_wait(free_slots, -1);
+    qmutex_lock(lock);
+    queue.push_back().swap(*buf);
+    qmutex_unlock(lock);
+    qsem_post(filled);
+  }
+
+  // Wait until all queued buffers are written
+  void finish()
+  {
+    if ( thread == NULL )
+      return;
+    qsem_post(filled); // the queue being empty tells the thread to stop
+    qthread_join(thread);
+    qthread_free(thread);
+    thread = NULL;
+  }
+
+  bool ok()
+  {
+    qmutex_lock(lock);
+    bool r = !failed;
+    qmutex_unlock(lock);
+    return r;
+  }
+};
+
+//-------------------------------------------------------------------------
+// Native colormap for the navigation band (see set_nav_colormap())
+static ea_interval_map_t<uint32> nav_colormap;
+static nav_colorizer_t *nav_colormap_fallback = NULL;
+static bool nav_colormap_installed = false;
+
+static uint32 idaapi nav_colormap_colorizer(ea_t ea, asize_t nbytes)
+{
+  const uint32 *color = nav_colormap.find_first(ea, ea + nbytes);
+  if ( color != NULL )
+    return *color;
+  return nav_colormap_fallback != NULL ? nav_colormap_fallback(ea, nbytes) : 0;
+}
+
 //------------------------------------------------------------------------
 //</decls(py_kernwin)>
 //------------------------------------------------------------------------
@@ -1128,6 +1243,173 @@ void py_gen_disasm_text(disasm_text_t &text, ea_t ea1, ea_t ea2, bool truncate_l
   }
 }
 
+//-------------------------------------------------------------------------
+// Renders at most 'max_items' items starting at 'ea1', and returns
+// a tuple (next_ea, [lines]). This is what iter_disasm_text() is built on:
+// unlike py_gen_disasm_text(), only one chunk of the listing is
+// materialized at any given time, and no place_t is cloned.
+PyObject *py_gen_disasm_text_chunk(
+        ea_t ea1,
+        ea_t ea2,
+        size_t max_items,
+        bool truncate_lines)
+{
+  ea_t chunk_end = ea1;
+  text_t _text;
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  Py_BEGIN_ALLOW_THREADS;
+  for ( size_t i = 0; i < max_items && chunk_end < ea2; ++i )
+  {
+    chunk_end = next_head(chunk_end, ea2);
+    if ( chunk_end == BADADDR )
+      chunk_end = ea2;
+  }
+  if ( chunk_end > ea2 )
+    chunk_end = ea2;
+  if ( chunk_end > ea1 )
+    gen_disasm_text(_text, ea1, chunk_end, truncate_lines);
+  Py_END_ALLOW_THREADS;
+  size_t n = _text.size();
+  newref_t py_lines(PyList_New(n));
+  for ( size_t i = 0; i < n; ++i )
+  {
+    twinline_t &tl = _text[i];
+    PyList_SET_ITEM(py_lines.o, i, PyString_FromStringAndSize(tl.line.c_str(), tl.line.length()));
+    qfree(tl.at); // twinline_t doesn't own its place
+    tl.at = NULL;
+  }
+  return Py_BuildValue("(" PY_BV_EA "O)", bvea_t(chunk_end), py_lines.o);
+}
+
+//-------------------------------------------------------------------------
+/*
+#<pydoc>
+def export_listing(path, ea1=0, ea2=BADADDR, flags=0, callback=None):
+    """
+    Write the disassembly listing of all segments intersecting [ea1, ea2)
+    to a file, natively.
+
+    The listing is rendered on the calling thread, while the I/O is
+    performed by a background thread: writing a segment overlaps
+    with rendering the next one.
+
+    @param path: the output file (overwritten)
+    @param ea1: start address
+    @param ea2: end address (excluded)
+    @param flags: combination of EXLF_... flags:
+                  EXLF_NOTAGS - remove color tags from the lines
+                  EXLF_TRUNCATE - truncate the lines like the listing does
+    @param callback: an optional callable, called with
+                     (segments_done, segments_total) once per segment.
+                     It can return True to cancel the export.
+    @return: the number of bytes written, or None if the file could not
+             be written or the export was cancelled (the partial file
+             is then deleted).
+    """
+    pass
+#</pydoc>
+*/
+#define EXLF_NOTAGS   0x0001
+#define EXLF_TRUNCATE 0x0002
+PyObject *py_export_listing(
+        const char *path,
+        ea_t ea1=0,
+        ea_t ea2=BADADDR,
+        int flags=0,
+        PyObject *callback=NULL)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  if ( callback == Py_None )
+    callback = NULL;
+  if ( callback != NULL && !PyCallable_Check(callback) )
+  {
+    PyErr_SetString(PyExc_TypeError, "callback must be callable");
+    return NULL;
+  }
+  FILE *fp = qfopen(path, "wb");
+  if ( fp == NULL )
+    Py_RETURN_NONE;
+
+  // render items in batches, and hand buffers of about 'BUFSZ' bytes
+  // over to the writer thread
+  const size_t BATCH_ITEMS = 4096;
+  const size_t BUFSZ = 1024 * 1024;
+  bool notags = (flags & EXLF_NOTAGS) != 0;
+  bool truncate_lines = (flags & EXLF_TRUNCATE) != 0;
+  bool cancelled = false;
+  uint64 total;
+  bool ok;
+  {
+    listing_writer_t writer(fp, 2);
+    qstring buf;
+    qstring notag;
+    int nsegs = get_segm_qty();
+    for ( int i = 0; i < nsegs && !cancelled && writer.ok(); ++i )
+    {
+      segment_t *s = getnseg(i);
+      if ( s == NULL || s->end_ea <= ea1 || s->start_ea >= ea2 )
+        continue;
+      ea_t start = qmax(s->start_ea, ea1);
+      ea_t end = qmin(s->end_ea, ea2);
+      Py_BEGIN_ALLOW_THREADS;
+      while ( start < end && writer.ok() )
+      {
+        ea_t chunk_end = start;
+        for ( size_t k = 0; k < BATCH_ITEMS && chunk_end < end; ++k )
+        {
+          chunk_end = next_head(chunk_end, end);
+          if ( chunk_end == BADADDR )
+            chunk_end = end;
+        }
+        text_t text;
+        gen_disasm_text(text, start, chunk_end, truncate_lines);
+        for ( size_t k = 0, n = text.size(); k < n; ++k )
+        {
+          twinline_t &tl = text[k];
+          if ( notags )
+          {
+            tag_remove(&notag, tl.line);
+            buf.append(notag);
+          }
+          else
+          {
+            buf.append(tl.line);
+          }
+          buf.append('\n');
+          qfree(tl.at); // twinline_t doesn't own its place
+          tl.at = NULL;
+        }
+        if ( buf.length() >= BUFSZ )
+          writer.push(&buf);
+        start = chunk_end;
+      }
+      if ( !buf.empty() )
+        writer.push(&buf);
+      Py_END_ALLOW_THREADS;
+      if ( callback != NULL )
+      {
+        newref_t py_res(PyObject_CallFunction(callback, "ii", i + 1, nsegs));
+        if ( PyW_ShowCbErr("export_listing") || PyObject_IsTrue(py_res.o) )
+          cancelled = true;
+      }
+    }
+    Py_BEGIN_ALLOW_THREADS;
+    writer.finish();
+    Py_END_ALLOW_THREADS;
+    total = writer.written;
+    ok = writer.ok();
+  }
+  if ( qfclose(fp) != 0 )
+    ok = false;
+  if ( cancelled || !ok )
+  {
+    // don't leave a partial listing behind
+    qunlink(path);
+    Py_RETURN_NONE;
+  }
+  return PyLong_FromUnsignedLongLong(total);
+}
+
 //-------------------------------------------------------------------------
 /*
 #<pydoc>
@@ -1198,10 +1480,140 @@ nav_colorizer_t *py_set_nav_colorizer(PyObject *new_py_colorizer)
   // (e.g., updating the legend.)
   bool first_install = py_colorizer == NULL;
   py_colorizer = borref_t(new_py_colorizer);
+  nav_colormap_installed = false;
   nav_colorizer_t *prev = set_nav_colorizer(lambda_t::call_py_colorizer);
   return first_install ? prev : NULL;
 }
 
+//-------------------------------------------------------------------------
+/*
+#<pydoc>
+def enable_nav_colormap(enable=True):
+    """
+    Install (or uninstall) a navigation band colorizer that takes its
+    colors from a native colormap, filled with set_nav_colormap() and
+    update_nav_colormap(). Painting the navigation band then doesn't
+    call into Python at all.
+
+    Addresses that are not in the colormap get the color of the
+    colorizer that was installed before (usually the IDA-provided one).
+    The colormap is emptied when the database is closed.
+
+    @param enable: True to install the colormap colorizer, False to
+                   restore the previous colorizer
+    @return: success
+    """
+    pass
+#</pydoc>
+*/
+bool enable_nav_colormap(bool enable=true)
+{
+  if ( enable == nav_colormap_installed )
+    return true;
+  if ( enable )
+  {
+    nav_colorizer_t *prev = set_nav_colorizer(nav_colormap_colorizer);
+    if ( prev != nav_colormap_colorizer )
+      nav_colormap_fallback = prev;
+  }
+  else
+  {
+    // without a previous colorizer, go back to the default colors
+    set_nav_colorizer(nav_colormap_fallback);
+  }
+  nav_colormap_installed = enable;
+  refresh_navband(true);
+  return true;
+}
+
+//-------------------------------------------------------------------------
+/*
+#<pydoc>
+def update_nav_colormap(ranges):
+    """
+    Update some ranges of the navigation band colormap, leaving
+    the rest of it untouched. See enable_nav_colormap().
+
+    @param ranges: a list of (start, end, color) tuples, applied in
+                   order. A None color removes the range from the colormap.
+    @return: the number of ranges in the colormap
+    """
+    pass
+#</pydoc>
+*/
+static PyObject *py_update_nav_colormap(PyObject *py_ranges)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  struct ida_local lambda_t
+  {
+    static int idaapi cvt(const ref_t &py_item, Py_ssize_t /*i*/, void *)
+    {
+      bvea_t start, end;
+      PyObject *py_color;
+      if ( !PyArg_ParseTuple(py_item.o, PY_BV_EA PY_BV_EA "O", &start, &end, &py_color) )
+        return CIP_FAILED;
+      if ( py_color == Py_None )
+      {
+        nav_colormap.erase(ea_t(start), ea_t(end));
+        return CIP_OK;
+      }
+      uint64 color;
+      if ( !PyW_GetNumber(py_color, &color) )
+        return CIP_FAILED;
+      nav_colormap.set(ea_t(start), ea_t(end), uint32(color));
+      return CIP_OK;
+    }
+  };
+  Py_ssize_t n = pyvar_walk_list(py_ranges, lambda_t::cvt);
+  if ( n < 0 )
+  {
+    if ( !PyErr_Occurred() )
+      PyErr_SetString(PyExc_TypeError, "expected a list of (start, end, color) tuples");
+    return NULL;
+  }
+  if ( nav_colormap_installed )
+    refresh_navband(true);
+  return PyInt_FromSize_t(nav_colormap.size());
+}
+
+//-------------------------------------------------------------------------
+/*
+#<pydoc>
+def set_nav_colormap(ranges):
+    """
+    Replace the contents of the navigation band colormap.
+    See enable_nav_colormap().
+
+    @param ranges: a list of (start, end, color) tuples. Later ranges
+                   override the earlier ones they overlap.
+    @return: the number of ranges in the colormap
+    """
+    pass
+#</pydoc>
+*/
+static PyObject *py_set_nav_colormap(PyObject *py_ranges)
+{
+  nav_colormap.clear();
+  return py_update_nav_colormap(py_ranges);
+}
+
+//-------------------------------------------------------------------------
+/*
+#<pydoc>
+def clear_nav_colormap():
+    """
+    Remove all the ranges from the navigation band colormap
+    """
+    pass
+#</pydoc>
+*/
+void clear_nav_colormap()
+{
+  nav_colormap.clear();
+  if ( nav_colormap_installed )
+    refresh_navband(true);
+}
+
 //-------------------------------------------------------------------------
 /*
 #<pydoc>
@@ -1337,6 +1749,18 @@ def get_navband_pixel(ea):
 #</pydoc>
 */
 
+//-------------------------------------------------------------------------
+static void ida_kernwin_term(void)
+{
+  nav_colormap.clear();
+}
+
+//-------------------------------------------------------------------------
+static void ida_kernwin_closebase(void)
+{
+  nav_colormap.clear();
+}
+
 //</code(py_kernwin)>
 
 #endif
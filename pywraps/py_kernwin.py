@@ -65,6 +65,28 @@ def ask_seg(defval, format):
 def ask_ident(defval, format):
     return ask_str(defval, HIST_IDENT, format)
 
+# ----------------------------------------------------------------------
+def iter_disasm_text(ea1, ea2, truncate_lines=False, chunk_items=256):
+    """
+    Generate the disassembly text for the [ea1, ea2) range, chunk by chunk.
+
+    Contrary to gen_disasm_text(), the listing is never materialized
+    as a whole: at most 'chunk_items' items are rendered at once, so the
+    memory usage is the same no matter how big the range is, and the
+    first lines are available immediately.
+
+    @param ea1: start address
+    @param ea2: end address (excluded)
+    @param truncate_lines: see gen_disasm_text()
+    @param chunk_items: number of items to render per chunk
+    @return: a generator of (colored) lines
+    """
+    ea = ea1
+    while ea < ea2:
+        ea, lines = _ida_kernwin._gen_disasm_text_chunk(ea, ea2, chunk_items, truncate_lines)
+        for line in lines:
+            yield line
+
 # ----------------------------------------------------------------------
 class action_handler_t(object):
     def __init__(self):
@@ -36,6 +36,294 @@ static void py_get_int(PyObject *self, T *prm, const char *name)
     *prm = T(PyInt_AsLong(attr.o));
 }
 
+//------------------------------------------------------------------------
+// Column store for choosers whose contents are supplied at once
+// (see Choose.SetTable()). Rows are rendered, filtered, sorted
+// and searched natively, without calling into Python.
+struct py_choose_table_t
+{
+  qvector<qstrvec_t> cols;  // cells, column by column
+  intvec_t icons;           // per-row icons (optional)
+  intvec_t colors;          // per-row background colors (optional)
+  intvec_t flags;           // per-row CHITEM_... flags (optional)
+  intvec_t col_formats;     // CHCOL_... format of each column
+  size_t nrows;
+
+  // the displayed rows, when filtered and/or sorted
+  sizevec_t view;
+  bool has_view;
+  int sort_col;             // -1: not sorted
+  bool sort_desc;
+  int filter_col;           // -1: all columns
+  qstring filter_text;      // lowercase; empty: not filtered
+
+  py_choose_table_t()
+    : nrows(0), has_view(false), sort_col(-1), sort_desc(false), filter_col(-1) {}
+
+  size_t count() const { return has_view ? view.size() : nrows; }
+  size_t row(size_t n) const { return has_view ? view[n] : n; }
+
+  void get_row(
+          qstrvec_t *out,
+          int *icon,
+          chooser_item_attrs_t *attrs,
+          size_t n) const
+  {
+    if ( n >= count() )
+      return;
+    size_t r = row(n);
+    for ( size_t i = 0, ncols = qmin(cols.size(), out->size()); i < ncols; ++i )
+      (*out)[i] = cols[i][r];
+    if ( !icons.empty() )
+      *icon = icons[r];
+    if ( !colors.empty() )
+      attrs->color = colors[r];
+    if ( !flags.empty() )
+      attrs->flags = flags[r];
+  }
+
+  // does the cell contain 'text' (lowercase), case-insensitively?
+  static bool cell_contains(const qstring &cell, const qstring &text)
+  {
+    if ( text.length() > cell.length() )
+      return false;
+    size_t last = cell.length() - text.length();
+    for ( size_t i = 0; i <= last; ++i )
+    {
+      size_t k = 0;
+      while ( k < text.length() && qtolower(cell[i+k]) == text[k] )
+        ++k;
+      if ( k == text.length() )
+        return true;
+    }
+    return false;
+  }
+
+  bool row_matches(size_t r, int col, const qstring &text) const
+  {
+    if ( col >= 0 )
+      return cell_contains(cols[col][r], text);
+    for ( size_t i = 0; i < cols.size(); ++i )
+      if ( cell_contains(cols[i][r], text) )
+        return true;
+    return false;
+  }
+
+  struct row_lt_t
+  {
+    const qstrvec_t &cells;
+    int base; // 0: compare as strings, otherwise as numbers in that base
+    bool desc;
+    row_lt_t(const qstrvec_t &_cells, int _base, bool _desc)
+      : cells(_cells), base(_base), desc(_desc) {}
+    bool operator()(size_t a, size_t b) const
+    {
+      if ( desc )
+        qswap(a, b);
+      if ( base != 0 )
+      {
+        uint64 va = strtoull(cells[a].c_str(), NULL, base);
+        uint64 vb = strtoull(cells[b].c_str(), NULL, base);
+        if ( va != vb )
+          return va < vb;
+      }
+      return cells[a] < cells[b];
+    }
+  };
+
+  // recompute the displayed rows from the filter and sort settings
+  void rebuild_view()
+  {
+    view.clear();
+    has_view = !filter_text.empty() || sort_col >= 0;
+    if ( !has_view )
+      return;
+    view.reserve(nrows);
+    for ( size_t r = 0; r < nrows; ++r )
+      if ( filter_text.empty() || row_matches(r, filter_col, filter_text) )
+        view.push_back(r);
+    if ( sort_col >= 0 )
+    {
+      int fmt = col_formats[sort_col] & CHCOL_FORMAT;
+      int base = fmt == CHCOL_HEX ? 16 : fmt == CHCOL_DEC ? 10 : 0;
+      std::stable_sort(view.begin(), view.end(), row_lt_t(cols[sort_col], base, sort_desc));
+    }
+  }
+
+  // find the first displayed row, at or after 'start', that contains 'text'
+  ssize_t find(int col, const char *text, size_t start) const
+  {
+    qstring lower(text);
+    qstrlwr(lower.begin());
+    for ( size_t n = start, cnt = count(); n < cnt; ++n )
+      if ( row_matches(row(n), col, lower) )
+        return n;
+    return -1;
+  }
+
+  static bool py_to_ints(intvec_t *out, PyObject *py_seq, size_t expected)
+  {
+    out->clear();
+    if ( py_seq == NULL || py_seq == Py_None )
+      return true;
+    newref_t py_fast(PySequence_Fast(py_seq, "expected a sequence"));
+    if ( py_fast == NULL || size_t(PySequence_Fast_GET_SIZE(py_fast.o)) != expected )
+      return false;
+    out->resize(expected);
+    PyObject **items = PySequence_Fast_ITEMS(py_fast.o);
+    for ( size_t i = 0; i < expected; ++i )
+      (*out)[i] = int(PyInt_AsLong(items[i]));
+    return !PyErr_Occurred();
+  }
+
+  static bool py_to_cells(qstrvec_t *out, PyObject *py_seq)
+  {
+    newref_t py_fast(PySequence_Fast(py_seq, "expected a sequence"));
+    if ( py_fast == NULL )
+      return false;
+    size_t n = PySequence_Fast_GET_SIZE(py_fast.o);
+    out->resize(n);
+    PyObject **items = PySequence_Fast_ITEMS(py_fast.o);
+    for ( size_t i = 0; i < n; ++i )
+    {
+      char *str;
+      Py_ssize_t len;
+      if ( PyString_Check(items[i]) )
+      {
+        PyString_AsStringAndSize(items[i], &str, &len);
+        (*out)[i].qclear();
+        (*out)[i].append(str, len);
+        continue;
+      }
+      newref_t py_str(PyObject_Str(items[i]));
+      if ( py_str == NULL || PyString_AsStringAndSize(py_str.o, &str, &len) == -1 )
+        return false;
+      (*out)[i].qclear();
+      (*out)[i].append(str, len);
+    }
+    return true;
+  }
+
+  // row operations (see Choose.AppendRows() & al.)
+  void append_row(const qstrvec_t &cells, int icon)
+  {
+    for ( size_t i = 0; i < cols.size(); ++i )
+      cols[i].push_back(i < cells.size() ? cells[i] : qstring());
+    if ( !icons.empty() )
+      icons.push_back(icon);
+    if ( !colors.empty() )
+      colors.push_back(DEFCOLOR);
+    if ( !flags.empty() )
+      flags.push_back(0);
+    ++nrows;
+  }
+
+  void update_row(size_t r, const qstrvec_t &cells)
+  {
+    for ( size_t i = 0; i < cols.size() && i < cells.size(); ++i )
+      cols[i][r] = cells[i];
+  }
+
+  // 'rows' must be sorted and without duplicates
+  void delete_rows(const sizevec_t &rows)
+  {
+    if ( rows.empty() )
+      return;
+    struct ida_local compactor_t
+    {
+      static void compact(intvec_t &v, const sizevec_t &rows)
+      {
+        if ( v.empty() )
+          return;
+        size_t out = 0;
+        for ( size_t r = 0, k = 0; r < v.size(); ++r )
+        {
+          if ( k < rows.size() && rows[k] == r )
+            ++k;
+          else
+            v[out++] = v[r];
+        }
+        v.resize(out);
+      }
+    };
+    for ( size_t i = 0; i < cols.size(); ++i )
+    {
+      qstrvec_t &c = cols[i];
+      size_t out = 0;
+      for ( size_t r = 0, k = 0; r < nrows; ++r )
+      {
+        if ( k < rows.size() && rows[k] == r )
+          ++k;
+        else
+          c[out++].swap(c[r]);
+      }
+      c.resize(out);
+    }
+    compactor_t::compact(icons, rows);
+    compactor_t::compact(colors, rows);
+    compactor_t::compact(flags, rows);
+    nrows -= rows.size();
+  }
+
+  // load (columns, icons, colors, flags) from Python
+  bool load(PyObject *py_table, const intvec_t &formats)
+  {
+    PYW_GIL_CHECK_LOCKED_SCOPE();
+    PyObject *py_cols = NULL;
+    PyObject *py_icons = NULL;
+    PyObject *py_colors = NULL;
+    PyObject *py_flags = NULL;
+    if ( !PyArg_ParseTuple(py_table, "O|OOO", &py_cols, &py_icons, &py_colors, &py_flags) )
+      return false;
+    newref_t py_fast(PySequence_Fast(py_cols, "expected a list of columns"));
+    if ( py_fast == NULL )
+      return false;
+    size_t ncols = PySequence_Fast_GET_SIZE(py_fast.o);
+    if ( ncols != formats.size() )
+    {
+      PyErr_SetString(PyExc_ValueError, "the number of columns doesn't match 'cols'");
+      return false;
+    }
+    cols.resize(ncols);
+    nrows = 0;
+    for ( size_t i = 0; i < ncols; ++i )
+    {
+      if ( !py_to_cells(&cols[i], PySequence_Fast_GET_ITEM(py_fast.o, i)) )
+        return false;
+      if ( i == 0 )
+        nrows = cols[i].size();
+      else if ( cols[i].size() != nrows )
+        nrows = qmin(nrows, cols[i].size());
+    }
+    for ( size_t i = 0; i < ncols; ++i )
+      cols[i].resize(nrows);
+    if ( !py_to_ints(&icons, py_icons, nrows)
+      || !py_to_ints(&colors, py_colors, nrows)
+      || !py_to_ints(&flags, py_flags, nrows) )
+    {
+      if ( !PyErr_Occurred() )
+        PyErr_SetString(PyExc_ValueError, "icons, colors and flags must have one entry per row");
+      return false;
+    }
+    col_formats = formats;
+    rebuild_view();
+    return true;
+  }
+};
+
+//------------------------------------------------------------------------
+// A row, as returned by OnGetLine(), OnGetIcon() and OnGetLineAttr()
+// (see Choose's 'row_cache')
+struct py_choose_row_t
+{
+  qstrvec_t cols;
+  int icon;
+  chooser_item_attrs_t attrs;
+  bool valid;
+  py_choose_row_t() : icon(-1), valid(false) {}
+};
+DECLARE_TYPE_AS_MOVABLE(py_choose_row_t);
+
 //------------------------------------------------------------------------
 // Python's chooser class
 class py_choose_t
@@ -60,6 +348,7 @@ public:
     CHOOSE_HAVE_SELECT    = 0x0100,
     CHOOSE_HAVE_ONCLOSE   = 0x0200,
     CHOOSE_IS_EMBEDDED    = 0x0400,
+    CHOOSE_CACHE_ROWS     = 0x0800,
   };
 
   // Callback flags (to tell which callback exists and which not)
@@ -76,8 +365,17 @@ public:
   qstrvec_t header_strings;
   qvector<const char *> header;
 
+  // Column store, if the contents were supplied with Choose.SetTable()
+  py_choose_table_t *table;
+
+  // Rows already fetched from Python, and the number of rows (-1 if
+  // unknown), if CHOOSE_CACHE_ROWS. Python tells which rows changed
+  // with Choose.AppendRows() & al.; the others are served from here.
+  mutable qvector<py_choose_row_t> row_cache;
+  mutable ssize_t cached_count;
+
 public:
-  py_choose_t(PyObject *self_) : self(self_), chobj(NULL), cb_flags(0)
+  py_choose_t(PyObject *self_) : self(self_), chobj(NULL), cb_flags(0), table(NULL), cached_count(-1)
   {
     PYW_GIL_GET;
     choose_add_instance(self, this);
@@ -96,6 +394,7 @@ public:
     // Remove from list
     choose_del_instance(self);
 
+    delete table;
     Py_XDECREF(self);
   }
 
@@ -113,12 +412,19 @@ public:
 
   size_t idaapi get_count() const
   {
+    if ( table != NULL )
+      return table->count();
+    if ( (cb_flags & CHOOSE_CACHE_ROWS) != 0 && cached_count >= 0 )
+      return cached_count;
     PYW_GIL_GET;
     pycall_res_t pyres(PyObject_CallMethod(self, (char *)S_ON_GET_SIZE, NULL));
     if ( pyres.result == NULL || pyres.result.o == Py_None )
       return 0;
 
-    return size_t(PyInt_AsLong(pyres.result.o));
+    size_t cnt = size_t(PyInt_AsLong(pyres.result.o));
+    if ( (cb_flags & CHOOSE_CACHE_ROWS) != 0 )
+      cached_count = cnt;
+    return cnt;
   }
 
   void idaapi get_row(
@@ -126,6 +432,41 @@ public:
           int *icon_,
           chooser_item_attrs_t *attrs,
           size_t n) const
+  {
+    if ( table != NULL )
+    {
+      *icon_ = chobj->icon;
+      table->get_row(cols, icon_, attrs, n);
+      return;
+    }
+
+    if ( (cb_flags & CHOOSE_CACHE_ROWS) == 0 )
+    {
+      fetch_row(cols, icon_, attrs, n);
+      return;
+    }
+
+    if ( n >= row_cache.size() )
+      row_cache.resize(n + 1);
+    py_choose_row_t &row = row_cache[n];
+    if ( !row.valid )
+    {
+      row.cols = *cols;
+      row.attrs = *attrs;
+      fetch_row(&row.cols, &row.icon, &row.attrs, n);
+      row.valid = true;
+    }
+    *cols = row.cols;
+    *icon_ = row.icon;
+    *attrs = row.attrs;
+  }
+
+  // get a row from Python
+  void fetch_row(
+          qstrvec_t *cols,
+          int *icon_,
+          chooser_item_attrs_t *attrs,
+          size_t n) const
   {
     PYW_GIL_GET;
 
@@ -241,6 +582,45 @@ public:
     return chobj;
   }
 
+  // (Re)load the column store from a (columns, icons, colors, flags) tuple
+  bool set_table(PyObject *py_table)
+  {
+    py_choose_table_t *t = new py_choose_table_t;
+    if ( !t->load(py_table, widths) )
+    {
+      delete t;
+      return false;
+    }
+    if ( table != NULL )
+    {
+      // keep the current filter and sort order
+      t->sort_col = table->sort_col;
+      t->sort_desc = table->sort_desc;
+      t->filter_col = table->filter_col;
+      t->filter_text = table->filter_text;
+      t->rebuild_view();
+      delete table;
+    }
+    table = t;
+    return true;
+  }
+
+  py_choose_table_t *get_table() const
+  {
+    return table;
+  }
+
+  // Row operations. With a column store, they are applied to it;
+  // otherwise they tell the row cache which rows must be fetched again.
+  bool append_rows(PyObject *py_rows);
+  bool update_rows(const sizevec_t &rows, PyObject *py_rows);
+  bool delete_rows(sizevec_t rows);
+  void invalidate_rows()
+  {
+    row_cache.clear();
+    cached_count = -1;
+  }
+
   bool is_valid() const
   {
     return chobj != NULL;
@@ -588,6 +968,24 @@ int py_choose_t::create()
     widths[i] = width;
   }
 
+  // Cache the rows fetched from Python?
+  ref_t row_cache_attr(PyW_TryGetAttrString(self, "row_cache"));
+  if ( row_cache_attr != NULL && PyObject_IsTrue(row_cache_attr.o) == 1 )
+    cb_flags |= CHOOSE_CACHE_ROWS;
+
+  // Contents supplied at once? (see Choose.SetTable())
+  ref_t table_attr(PyW_TryGetAttrString(self, "_table"));
+  if ( table_attr != NULL && table_attr.o != Py_None )
+  {
+    if ( !set_table(table_attr.o) )
+    {
+      PyW_ShowCbErr("SetTable");
+      return chooser_base_t::NO_ATTR;
+    }
+    // the column store is native now; don't keep 2 copies of the data
+    PyObject_SetAttrString(self, "_table", Py_None);
+  }
+
   // Check what callbacks we have
   static const struct
   {
@@ -614,7 +1012,7 @@ int py_choose_t::create()
   ref_t forbidden_cb_attr(PyW_TryGetAttrString(self, "forbidden_cb"));
   if ( forbidden_cb_attr != NULL && PyInt_Check(forbidden_cb_attr.o) )
     forbidden_cb = uint32(PyInt_AsLong(forbidden_cb_attr.o));
-  cb_flags = 0;
+  cb_flags &= CHOOSE_CACHE_ROWS;
   for ( int i = 0; i < qnumber(callbacks); ++i )
   {
     ref_t cb_attr(PyW_TryGetAttrString(self, callbacks[i].name));
@@ -626,8 +1024,8 @@ int py_choose_t::create()
     }
     else
     {
-      // Mandatory field?
-      if ( callbacks[i].have == 0 )
+      // Mandatory field? (not when the rows come from a column store)
+      if ( callbacks[i].have == 0 && table == NULL )
         return chooser_base_t::NO_ATTR;
     }
   }
@@ -711,6 +1109,99 @@ int py_choose_t::create()
   return res;
 }
 
+//------------------------------------------------------------------------
+bool py_choose_t::append_rows(PyObject *py_rows)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  if ( table == NULL )
+  {
+    // the number of rows that were appended
+    if ( !PyInt_Check(py_rows) && !PyLong_Check(py_rows) )
+    {
+      PyErr_SetString(PyExc_TypeError, "expected the number of appended rows");
+      return false;
+    }
+    if ( cached_count >= 0 )
+      cached_count += PyInt_AsSsize_t(py_rows);
+    return true;
+  }
+  newref_t py_fast(PySequence_Fast(py_rows, "expected a list of rows"));
+  if ( py_fast == NULL )
+    return false;
+  qstrvec_t cells;
+  for ( Py_ssize_t i = 0, n = PySequence_Fast_GET_SIZE(py_fast.o); i < n; ++i )
+  {
+    if ( !py_choose_table_t::py_to_cells(&cells, PySequence_Fast_GET_ITEM(py_fast.o, i)) )
+      return false;
+    table->append_row(cells, chobj->icon);
+  }
+  table->rebuild_view();
+  return true;
+}
+
+//------------------------------------------------------------------------
+bool py_choose_t::update_rows(const sizevec_t &rows, PyObject *py_rows)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  if ( table == NULL )
+  {
+    for ( size_t i = 0; i < rows.size(); ++i )
+      if ( rows[i] < row_cache.size() )
+        row_cache[rows[i]].valid = false;
+    return true;
+  }
+  newref_t py_fast(PySequence_Fast(py_rows, "expected a list of rows"));
+  if ( py_fast == NULL )
+    return false;
+  if ( size_t(PySequence_Fast_GET_SIZE(py_fast.o)) != rows.size() )
+  {
+    PyErr_SetString(PyExc_ValueError, "expected one row per index");
+    return false;
+  }
+  qstrvec_t cells;
+  for ( size_t i = 0; i < rows.size(); ++i )
+  {
+    if ( rows[i] >= table->nrows )
+    {
+      PyErr_SetString(PyExc_IndexError, "row index out of range");
+      return false;
+    }
+    if ( !py_choose_table_t::py_to_cells(&cells, PySequence_Fast_GET_ITEM(py_fast.o, i)) )
+      return false;
+    table->update_row(rows[i], cells);
+  }
+  table->rebuild_view();
+  return true;
+}
+
+//------------------------------------------------------------------------
+bool py_choose_t::delete_rows(sizevec_t rows)
+{
+  std::sort(rows.begin(), rows.end());
+  rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+  if ( table != NULL )
+  {
+    while ( !rows.empty() && rows.back() >= table->nrows )
+      rows.pop_back();
+    table->delete_rows(rows);
+    table->rebuild_view();
+    return true;
+  }
+  // the rows after a deleted one move up
+  size_t out = 0;
+  for ( size_t r = 0, k = 0; r < row_cache.size(); ++r )
+  {
+    if ( k < rows.size() && rows[k] == r )
+      ++k;
+    else
+      qswap(row_cache[out++], row_cache[r]);
+  }
+  row_cache.resize(out);
+  if ( cached_count >= 0 )
+    cached_count -= std::lower_bound(rows.begin(), rows.end(), size_t(cached_count)) - rows.begin();
+  return true;
+}
+
 //------------------------------------------------------------------------
 int choose_create(PyObject *self)
 {
@@ -762,7 +1253,10 @@ void choose_refresh(PyObject *self)
 {
   py_choose_t *pych = choose_find_instance(self);
   if ( pych != NULL && pych->is_valid() )
+  {
+    pych->invalidate_rows();
     pych->do_refresh();
+  }
 }
 
 //------------------------------------------------------------------------
@@ -785,6 +1279,128 @@ uint64 _choose_get_embedded_chobj_pointer(PyObject *self)
   return ptr;
 }
 
+//------------------------------------------------------------------------
+PyObject *choose_set_table(PyObject *self, PyObject *py_table)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  py_choose_t *pych = choose_find_instance(self);
+  if ( pych == NULL || !pych->is_valid() )
+    Py_RETURN_FALSE;
+  if ( !pych->set_table(py_table) )
+    return NULL;
+  pych->do_refresh();
+  Py_RETURN_TRUE;
+}
+
+//------------------------------------------------------------------------
+static py_choose_t *choose_find_valid_instance(PyObject *self)
+{
+  py_choose_t *pych = choose_find_instance(self);
+  return pych != NULL && pych->is_valid() ? pych : NULL;
+}
+
+//------------------------------------------------------------------------
+PyObject *choose_append_rows(PyObject *self, PyObject *py_rows, bool refresh)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  py_choose_t *pych = choose_find_valid_instance(self);
+  if ( pych == NULL )
+    Py_RETURN_FALSE;
+  if ( !pych->append_rows(py_rows) )
+    return NULL;
+  if ( refresh )
+    pych->do_refresh();
+  Py_RETURN_TRUE;
+}
+
+//------------------------------------------------------------------------
+PyObject *choose_update_rows(PyObject *self, PyObject *py_indexes, PyObject *py_rows, bool refresh)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  py_choose_t *pych = choose_find_valid_instance(self);
+  if ( pych == NULL )
+    Py_RETURN_FALSE;
+  sizevec_t rows;
+  if ( PyW_PyListToSizeVec(&rows, py_indexes) < 0
+    || !pych->update_rows(rows, py_rows) )
+  {
+    return NULL;
+  }
+  if ( refresh )
+    pych->do_refresh();
+  Py_RETURN_TRUE;
+}
+
+//------------------------------------------------------------------------
+PyObject *choose_delete_rows(PyObject *self, PyObject *py_indexes, bool refresh)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  py_choose_t *pych = choose_find_valid_instance(self);
+  if ( pych == NULL )
+    Py_RETURN_FALSE;
+  sizevec_t rows;
+  if ( PyW_PyListToSizeVec(&rows, py_indexes) < 0 )
+    return NULL;
+  pych->delete_rows(rows);
+  if ( refresh )
+    pych->do_refresh();
+  Py_RETURN_TRUE;
+}
+
+//------------------------------------------------------------------------
+static py_choose_table_t *choose_find_table(PyObject *self)
+{
+  py_choose_t *pych = choose_find_instance(self);
+  return pych == NULL || !pych->is_valid() ? NULL : pych->get_table();
+}
+
+//------------------------------------------------------------------------
+ssize_t choose_sort_table(PyObject *self, int col, bool descending)
+{
+  py_choose_t *pych = choose_find_instance(self);
+  py_choose_table_t *t = choose_find_table(self);
+  if ( t == NULL || col >= int(t->cols.size()) )
+    return -1;
+  t->sort_col = col;
+  t->sort_desc = descending;
+  t->rebuild_view();
+  pych->do_refresh();
+  return t->count();
+}
+
+//------------------------------------------------------------------------
+ssize_t choose_filter_table(PyObject *self, const char *text, int col)
+{
+  py_choose_t *pych = choose_find_instance(self);
+  py_choose_table_t *t = choose_find_table(self);
+  if ( t == NULL || col >= int(t->cols.size()) )
+    return -1;
+  t->filter_text = text;
+  qstrlwr(t->filter_text.begin());
+  t->filter_col = col;
+  t->rebuild_view();
+  pych->do_refresh();
+  return t->count();
+}
+
+//------------------------------------------------------------------------
+ssize_t choose_find_in_table(PyObject *self, const char *text, int col, size_t start)
+{
+  py_choose_table_t *t = choose_find_table(self);
+  if ( t == NULL || col >= int(t->cols.size()) )
+    return -1;
+  return t->find(col, text, start);
+}
+
+//------------------------------------------------------------------------
+ssize_t choose_get_table_row(PyObject *self, size_t n)
+{
+  py_choose_table_t *t = choose_find_table(self);
+  if ( t == NULL || n >= t->count() )
+    return -1;
+  return t->row(n);
+}
+
 //------------------------------------------------------------------------
 PyObject *choose_find(const char *title)
 {
@@ -805,6 +1421,14 @@ void choose_close(PyObject *self);
 int choose_create(PyObject *self);
 void choose_activate(PyObject *self);
 uint64 _choose_get_embedded_chobj_pointer(PyObject *self);
+PyObject *choose_set_table(PyObject *self, PyObject *py_table);
+ssize_t choose_sort_table(PyObject *self, int col, bool descending);
+ssize_t choose_filter_table(PyObject *self, const char *text, int col);
+ssize_t choose_find_in_table(PyObject *self, const char *text, int col, size_t start);
+ssize_t choose_get_table_row(PyObject *self, size_t n);
+PyObject *choose_append_rows(PyObject *self, PyObject *py_rows, bool refresh);
+PyObject *choose_update_rows(PyObject *self, PyObject *py_indexes, PyObject *py_rows, bool refresh);
+PyObject *choose_delete_rows(PyObject *self, PyObject *py_indexes, bool refresh);
 
 PyObject *py_get_chooser_data(const char *chooser_caption, int n)
 {
@@ -115,7 +115,7 @@ class Choose(object):
                  icon=-1, x1=-1, y1=-1, x2=-1, y2=-1,
                  deflt = None,
                  embedded = False, width = None, height = None,
-                 forbidden_cb = 0):
+                 forbidden_cb = 0, row_cache = False):
         """
         Constructs a chooser window.
         @param title: The chooser title
@@ -135,6 +135,12 @@ class Choose(object):
         @param width: Embedded chooser width
         @param height: Embedded chooser height
         @param forbidden_cb: Explicitly forbidden callbacks
+        @param row_cache: Keep the rows returned by OnGetLine(), OnGetIcon()
+            and OnGetLineAttr(), as well as OnGetSize(), natively. They are
+            only requested again when they are reported as changed with
+            AppendRows(), UpdateRows() or DeleteRows(), or after Refresh().
+            The chooser's own refresh action keeps the cached rows: an
+            OnRefresh() that changes rows must report them.
         """
         self.title = title
         self.flags = flags
@@ -152,7 +158,9 @@ class Choose(object):
         self.width = width
         self.height = height
         self.forbidden_cb = forbidden_cb
+        self.row_cache = row_cache
         self.ui_hooks_trampoline = None # set on Show
+        self._table = None # see SetTable()
 
 
     def Embedded(self):
@@ -213,7 +221,12 @@ class Choose(object):
 
 
     def Refresh(self):
-        """Causes the refresh callback to trigger"""
+        """
+        Causes the refresh callback to trigger.
+        All the rows are requested again (see AppendRows() & al.
+        for incremental updates). This is the only refresh that drops
+        the rows kept with 'row_cache'.
+        """
         return _ida_kernwin.choose_refresh(self)
 
 
@@ -229,6 +242,112 @@ class Choose(object):
         """
         return _ida_kernwin.choose_get_widget(self)
 
+    def SetTable(self, columns, icons=None, colors=None, flags=None):
+        """
+        Supply the whole contents of the chooser at once, as a column store.
+        The rows are then rendered, filtered, sorted and searched natively:
+        OnGetSize(), OnGetLine(), OnGetIcon() and OnGetLineAttr() are
+        neither needed nor called.
+
+        This can be called before Show() (the data is handed over to the
+        chooser when it is created), or later to replace the contents.
+        The current filter and sort order are preserved.
+
+        Other callbacks (OnSelectLine(), ...) receive the numbers of the
+        displayed rows; use GetTableRow() to get the corresponding
+        row in the table.
+
+        @param columns: a list of columns, one per entry in 'cols'. Each
+            column is a list of strings (other objects are converted
+            with str()), and all columns have the same number of rows.
+        @param icons: an optional list of icons, one per row
+        @param colors: an optional list of background colors, one per row
+        @param flags: an optional list of CHITEM_... flags, one per row
+        @return: success
+        """
+        table = (columns, icons, colors, flags)
+        if _ida_kernwin.choose_set_table(self, table):
+            return True
+        # not created yet
+        self._table = table
+        return True
+
+    def SortTable(self, col, descending=False):
+        """
+        Sort the rows of a chooser populated with SetTable(). Columns
+        with the CHCOL_HEX or CHCOL_DEC format are sorted numerically.
+        @param col: column number, or -1 to restore the original order
+        @return: the number of displayed rows, or -1 on failure
+        """
+        return _ida_kernwin.choose_sort_table(self, col, descending)
+
+    def FilterTable(self, text, col=-1):
+        """
+        Only display the rows containing 'text' (case-insensitively),
+        in a chooser populated with SetTable().
+        @param text: the text to look for. An empty text removes the filter
+        @param col: the column to look into, or -1 for all columns
+        @return: the number of displayed rows, or -1 on failure
+        """
+        return _ida_kernwin.choose_filter_table(self, text, col)
+
+    def FindInTable(self, text, col=-1, start=0):
+        """
+        Find the first displayed row, starting with row 'start', that
+        contains 'text' (case-insensitively), in a chooser populated
+        with SetTable().
+        @return: the displayed row number, or -1
+        """
+        return _ida_kernwin.choose_find_in_table(self, text, col, start)
+
+    def GetTableRow(self, n):
+        """
+        Convert a displayed row number to a row number in the table
+        supplied to SetTable() (they differ when the table is filtered
+        or sorted).
+        @return: the table row, or -1
+        """
+        return _ida_kernwin.choose_get_table_row(self, n)
+
+    def AppendRows(self, rows, refresh=True):
+        """
+        Report rows appended to the chooser, and refresh it.
+        Only the new rows are requested when the chooser is repainted.
+        @param rows: for a chooser populated with SetTable(), a list of
+            rows to add to the table, each being a list of cells.
+            Otherwise (see 'row_cache'), the number of rows that were
+            appended to the data OnGetLine() serves.
+        @param refresh: False to apply other changes before refreshing
+        @return: success
+        """
+        return _ida_kernwin.choose_append_rows(self, rows, refresh)
+
+    def UpdateRows(self, indexes, rows=None, refresh=True):
+        """
+        Report changed rows, and refresh the chooser.
+        Only those rows are requested again when the chooser is repainted.
+        @param indexes: the numbers of the changed rows (for a chooser
+            populated with SetTable(), those are table rows; see
+            GetTableRow())
+        @param rows: for a chooser populated with SetTable(), the new
+            contents of the rows: a list of cells per index
+        @param refresh: False to apply other changes before refreshing
+        @return: success
+        """
+        return _ida_kernwin.choose_update_rows(self, indexes, rows, refresh)
+
+    def DeleteRows(self, indexes, refresh=True):
+        """
+        Report deleted rows, and refresh the chooser. The rows that
+        follow a deleted row move up, but are not requested again.
+        @param indexes: the numbers of the deleted rows (for a chooser
+            populated with SetTable(), those are table rows and they
+            are removed from it)
+        @param refresh: False to apply other changes before refreshing
+        @return: success
+        """
+        return _ida_kernwin.choose_delete_rows(self, indexes, refresh)
+
     def adjust_last_item(self, n):
         """
         Helper for OnDeleteLine() and OnRefresh() callbacks.
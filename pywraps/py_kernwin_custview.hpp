@@ -9,6 +9,7 @@ public:
   virtual void    *get_ud() = 0;
   virtual place_t *get_min() = 0;
   virtual place_t *get_max() = 0;
+  virtual size_t   to_lineno(const place_t *pl) const = 0;
 };
 
 //---------------------------------------------------------------------------
@@ -97,9 +98,9 @@ public:
     return true;
   }
 
-  const size_t to_lineno(place_t *pl) const
+  size_t to_lineno(const place_t *pl) const
   {
-    return ((simpleline_place_t *)pl)->n;
+    return ((const simpleline_place_t *)pl)->n;
   }
 
   bool curline(place_t *pl, size_t *n)
@@ -133,6 +134,206 @@ public:
   }
 };
 
+//---------------------------------------------------------------------------
+// A source of lines that are only produced when they are displayed,
+// instead of being all stored in a strvec_t (see lazyline_place_t)
+class lazyline_source_t
+{
+public:
+  virtual ~lazyline_source_t() {}
+  virtual size_t count() = 0;
+  virtual bool get_line(simpleline_t *out, size_t n) = 0;
+  // the number of lines changed
+  virtual void set_count(size_t) {}
+  // the lines in [start, end) changed
+  virtual void invalidate(size_t, size_t) {}
+  // for sources that are loaded in the background: the number
+  // of lines available so far, and whether loading finished
+  virtual bool get_progress(size_t *, bool *) { return false; }
+};
+
+//---------------------------------------------------------------------------
+// The place_t of the viewers that display a lazyline_source_t.
+// It is like simpleline_place_t, but its 'ud' is a lazyline_source_t
+// instead of a strvec_t.
+class lazyline_place_t : public place_t
+{
+public:
+  size_t n;
+  lazyline_place_t(size_t _n=0) : n(_n) { lnnum = 0; }
+  define_place_virtual_functions(lazyline_place_t);
+  static int place_id;
+};
+int lazyline_place_t::place_id = -1;
+
+//---------------------------------------------------------------------------
+static int get_lazyline_place_id()
+{
+  if ( lazyline_place_t::place_id < 0 )
+  {
+    lazyline_place_t tmpl;
+    lazyline_place_t::place_id = register_place_class(&tmpl, PCF_MAKEPLACE_ALLOCATES, &PLUGIN);
+  }
+  return lazyline_place_t::place_id;
+}
+
+#define LAZYSRC(ud) ((lazyline_source_t *) (ud))
+void idaapi lazyline_place_t::print(qstring *out_buf, void *) const
+{
+  out_buf->sprnt("%" FMT_Z, n);
+}
+uval_t idaapi lazyline_place_t::touval(void *) const
+{
+  return n;
+}
+place_t *idaapi lazyline_place_t::clone(void) const
+{
+  return new lazyline_place_t(*this);
+}
+void idaapi lazyline_place_t::copyfrom(const place_t *from)
+{
+  const lazyline_place_t *s = (const lazyline_place_t *) from;
+  n = s->n;
+  lnnum = s->lnnum;
+}
+place_t *idaapi lazyline_place_t::makeplace(void *, uval_t x, int _lnnum) const
+{
+  lazyline_place_t *p = new lazyline_place_t(size_t(x));
+  p->lnnum = _lnnum;
+  return p;
+}
+int idaapi lazyline_place_t::compare(const place_t *t2) const
+{
+  const lazyline_place_t *s = (const lazyline_place_t *) t2;
+  return n < s->n ? -1 : n > s->n ? 1 : 0;
+}
+void idaapi lazyline_place_t::adjust(void *ud)
+{
+  size_t cnt = LAZYSRC(ud)->count();
+  if ( n >= cnt )
+    n = cnt == 0 ? 0 : cnt - 1;
+  lnnum = 0;
+}
+bool idaapi lazyline_place_t::prev(void *)
+{
+  if ( n == 0 )
+    return false;
+  --n;
+  return true;
+}
+bool idaapi lazyline_place_t::next(void *ud)
+{
+  if ( n + 1 >= LAZYSRC(ud)->count() )
+    return false;
+  ++n;
+  return true;
+}
+bool idaapi lazyline_place_t::beginning(void *) const
+{
+  return n == 0;
+}
+bool idaapi lazyline_place_t::ending(void *ud) const
+{
+  return n + 1 >= LAZYSRC(ud)->count();
+}
+int idaapi lazyline_place_t::generate(
+        qstrvec_t *out,
+        int *out_deflnnum,
+        color_t *out_pfx_color,
+        bgcolor_t *out_bgcolor,
+        void *ud,
+        int maxsize) const
+{
+  if ( maxsize <= 0 || n >= LAZYSRC(ud)->count() )
+    return 0;
+  simpleline_t sl;
+  if ( !LAZYSRC(ud)->get_line(&sl, n) )
+    return 0;
+  out->push_back().swap(sl.line);
+  *out_deflnnum = 0;
+  *out_pfx_color = sl.color;
+  *out_bgcolor = sl.bgcolor;
+  return 1;
+}
+void idaapi lazyline_place_t::serialize(bytevec_t *out) const
+{
+  place_t__serialize(this, out);
+  out->pack_dq(n);
+}
+bool idaapi lazyline_place_t::deserialize(const uchar **pptr, const uchar *end)
+{
+  if ( !place_t__deserialize(this, pptr, end) || *pptr >= end )
+    return false;
+  n = size_t(unpack_dq(pptr, end));
+  return true;
+}
+int idaapi lazyline_place_t::id() const
+{
+  return get_lazyline_place_id();
+}
+const char *idaapi lazyline_place_t::name() const
+{
+  return "idapython_lazyline_place_t";
+}
+ea_t idaapi lazyline_place_t::toea() const
+{
+  return BADADDR;
+}
+bool idaapi lazyline_place_t::rebase(const segm_move_infos_t &)
+{
+  return true;
+}
+place_t *idaapi lazyline_place_t::enter(uint32 *) const
+{
+  return NULL;
+}
+void idaapi lazyline_place_t::leave(uint32) const
+{
+}
+#undef LAZYSRC
+
+//---------------------------------------------------------------------------
+class cvdata_lazyline_t: public custviewer_data_t
+{
+private:
+  lazyline_source_t *src;
+  lazyline_place_t pl_min, pl_max;
+public:
+  cvdata_lazyline_t() : src(NULL) {}
+  ~cvdata_lazyline_t() { delete src; }
+
+  void *get_ud() { return src; }
+  place_t *get_min() { return &pl_min; }
+  place_t *get_max() { return &pl_max; }
+
+  size_t to_lineno(const place_t *pl) const
+  {
+    return ((const lazyline_place_t *)pl)->n;
+  }
+
+  lazyline_source_t *get_source() const { return src; }
+
+  // takes ownership of 'source'
+  void set_source(lazyline_source_t *source)
+  {
+    delete src;
+    src = source;
+    set_minmax();
+  }
+
+  void set_minmax()
+  {
+    size_t cnt = src == NULL ? 0 : src->count();
+    pl_min.n = 0;
+    pl_max.n = cnt == 0 ? 0 : cnt - 1;
+  }
+
+  size_t count() const
+  {
+    return src == NULL ? 0 : src->count();
+  }
+};
+
 //---------------------------------------------------------------------------
 // FIXME: This should inherit py_view_base.hpp's py_customidamemo_t,
 // just like py_graph.hpp's py_graph_t does.
@@ -460,9 +661,13 @@ class py_simplecustview_t: public customviewer_t
 {
 private:
   cvdata_simpleline_t data;
+  cvdata_lazyline_t lazy; // used instead of 'data' by virtual viewers
   PyObject *py_self, *py_this, *py_last_link;
   int features;
 
+  bool is_lazy() const { return lazy.get_source() != NULL; }
+
+public:
   //-------------------------------------------------------------------------
   static bool get_color(uint32 *out, ref_t obj)
   {
@@ -508,6 +713,7 @@ private:
     return true;
   }
 
+private:
   //
   // Callbacks
   //
@@ -579,7 +785,7 @@ private:
   // OnHint
   virtual bool on_hint(place_t *place, int *important_lines, qstring &hint)
   {
-    size_t ln = data.to_lineno(place);
+    size_t ln = _data->to_lineno(place);
     PYW_GIL_CHECK_LOCKED_SCOPE();
     newref_t py_result(
             PyObject_CallMethod(
@@ -617,7 +823,10 @@ private:
   //--------------------------------------------------------------------------
   void refresh_range()
   {
-    data.set_minmax();
+    if ( is_lazy() )
+      lazy.set_minmax();
+    else
+      data.set_minmax();
     set_range();
   }
 
@@ -635,7 +844,7 @@ public:
   bool edit_line(size_t nline, PyObject *py_sl)
   {
     simpleline_t sl;
-    if ( !py_to_simpleline(py_sl, sl) )
+    if ( is_lazy() || !py_to_simpleline(py_sl, sl) )
       return false;
 
     return data.set_line(nline, sl);
@@ -644,14 +853,14 @@ public:
   // Low level: patches a line string directly
   bool patch_line(size_t nline, size_t offs, int value)
   {
-    return data.patch_line(nline, offs, value);
+    return !is_lazy() && data.patch_line(nline, offs, value);
   }
 
   // Insert a line
   bool insert_line(size_t nline, PyObject *py_sl)
   {
     simpleline_t sl;
-    if ( !py_to_simpleline(py_sl, sl) )
+    if ( is_lazy() || !py_to_simpleline(py_sl, sl) )
       return false;
     return data.insert_line(nline, sl);
   }
@@ -660,7 +869,7 @@ public:
   bool add_line(PyObject *py_sl)
   {
     simpleline_t sl;
-    if ( !py_to_simpleline(py_sl, sl) )
+    if ( is_lazy() || !py_to_simpleline(py_sl, sl) )
       return false;
     data.add_line(sl);
     refresh_range();
@@ -670,7 +879,7 @@ public:
   //--------------------------------------------------------------------------
   bool del_line(size_t nline)
   {
-    bool ok = data.del_line(nline);
+    bool ok = !is_lazy() && data.del_line(nline);
     if ( ok )
       refresh_range();
     return ok;
@@ -686,14 +895,19 @@ public:
     PYW_GIL_CHECK_LOCKED_SCOPE();
     if ( pl == NULL )
       Py_RETURN_NONE;
-    return Py_BuildValue("(" PY_BV_SZ "ii)", bvsz_t(data.to_lineno(pl)), x, y);
+    return Py_BuildValue("(" PY_BV_SZ "ii)", bvsz_t(_data->to_lineno(pl)), x, y);
   }
 
   //--------------------------------------------------------------------------
   // Returns the line tuple
   PyObject *get_line(size_t nline)
   {
-    simpleline_t *r = data.get_line(nline);
+    simpleline_t lsl;
+    simpleline_t *r;
+    if ( is_lazy() )
+      r = nline < lazy.count() && lazy.get_source()->get_line(&lsl, nline) ? &lsl : NULL;
+    else
+      r = data.get_line(nline);
     PYW_GIL_CHECK_LOCKED_SCOPE();
     if ( r == NULL )
       Py_RETURN_NONE;
@@ -703,12 +917,14 @@ public:
   // Returns the count of lines
   const size_t count() const
   {
-    return data.count();
+    return is_lazy() ? lazy.count() : data.count();
   }
 
   // Clears lines
   void clear()
   {
+    if ( is_lazy() )
+      return;
     data.clear_lines();
     refresh_range();
   }
@@ -716,10 +932,29 @@ public:
   //--------------------------------------------------------------------------
   bool jumpto(size_t ln, int x, int y)
   {
+    if ( is_lazy() )
+    {
+      lazyline_place_t l(ln);
+      return customviewer_t::jumpto(&l, x, y);
+    }
     simpleline_place_t l(ln);
     return customviewer_t::jumpto(&l, x, y);
   }
 
+  //--------------------------------------------------------------------------
+  // Virtual viewers: the lines come from a lazyline_source_t
+  lazyline_source_t *get_source() const
+  {
+    return lazy.get_source();
+  }
+
+  // The number of lines of the source changed
+  void update_range()
+  {
+    refresh_range();
+    refresh();
+  }
+
   //--------------------------------------------------------------------------
   // Initializes and links the Python object to this class
   bool init(PyObject *py_link, const char *title)
@@ -751,7 +986,13 @@ public:
         features |= cbtable[i].feature;
     }
 
-    if ( !create(title, features, &data) )
+    custviewer_data_t *src_data = &data;
+    if ( is_lazy() )
+    {
+      get_lazyline_place_id();
+      src_data = &lazy;
+    }
+    if ( !create(title, features, src_data) )
       return false;
 
     // Hold a reference to this object
@@ -765,6 +1006,20 @@ public:
     return true;
   }
 
+  //--------------------------------------------------------------------------
+  // Same as init(), for a viewer whose lines come from 'source'.
+  // Takes ownership of 'source'.
+  bool init_lazy(PyObject *py_link, const char *title, lazyline_source_t *source)
+  {
+    if ( _cv != NULL )
+    {
+      delete source;
+      return false;
+    }
+    lazy.set_source(source);
+    return init(py_link, title);
+  }
+
   //--------------------------------------------------------------------------
   bool show()
   {
@@ -788,9 +1043,9 @@ public:
       return false;
 
     if ( y1 != NULL )
-      *y1 = data.to_lineno(p1.at);
+      *y1 = _data->to_lineno(p1.at);
     if ( y2 != NULL )
-      *y2 = data.to_lineno(p2.at);
+      *y2 = _data->to_lineno(p2.at);
     if ( x1 != NULL )
       *x1 = size_t(p1.x);
     if ( x2 != NULL )
@@ -821,6 +1076,288 @@ public:
   }
 };
 
+//---------------------------------------------------------------------------
+// Lines provided by a Python callable, a page at a time. At most
+// 'max_pages' pages are kept, the least recently used one is dropped
+// first: the memory use doesn't depend on the number of lines.
+class py_lazyline_source_t : public lazyline_source_t
+{
+  struct page_t
+  {
+    strvec_t lines;
+    uint64 last_use;
+  };
+  typedef std::map<size_t, page_t> pages_t;
+  pages_t pages;
+  ref_t provider;
+  size_t nlines;
+  size_t page_size;
+  size_t max_pages;
+  uint64 use_counter;
+
+  page_t *fetch_page(size_t pgno)
+  {
+    size_t start = pgno * page_size;
+    size_t cnt = qmin(page_size, nlines - start);
+    if ( pages.size() >= max_pages )
+    {
+      pages_t::iterator lru = pages.begin();
+      for ( pages_t::iterator p = pages.begin(); p != pages.end(); ++p )
+        if ( p->second.last_use < lru->second.last_use )
+          lru = p;
+      pages.erase(lru);
+    }
+    page_t &pg = pages[pgno];
+    PYW_GIL_GET;
+    newref_t py_lines(
+            PyObject_CallFunction(
+                    provider.o,
+                    PY_BV_SZ PY_BV_SZ,
+                    bvsz_t(start),
+                    bvsz_t(cnt)));
+    if ( !PyW_ShowCbErr("lazy custom viewer") && py_lines != NULL )
+    {
+      newref_t py_fast(PySequence_Fast(py_lines.o, "expected a list of lines"));
+      if ( py_fast == NULL )
+      {
+        PyW_ShowCbErr("lazy custom viewer");
+      }
+      else
+      {
+        size_t n = qmin(size_t(PySequence_Fast_GET_SIZE(py_fast.o)), cnt);
+        pg.lines.resize(n);
+        for ( size_t i = 0; i < n; ++i )
+          py_simplecustview_t::py_to_simpleline(PySequence_Fast_GET_ITEM(py_fast.o, i), pg.lines[i]);
+      }
+    }
+    // the lines the provider failed to return are kept as empty lines,
+    // so that it is not asked (and does not fail) again at every repaint;
+    // InvalidateLines() requests them again
+    pg.lines.resize(cnt);
+    return &pg;
+  }
+
+public:
+  py_lazyline_source_t(PyObject *py_provider, size_t _nlines, size_t _page_size, size_t _max_pages)
+    : provider(borref_t(py_provider)),
+      nlines(_nlines),
+      page_size(qmax(_page_size, size_t(1))),
+      max_pages(qmax(_max_pages, size_t(1))),
+      use_counter(0) {}
+
+  ~py_lazyline_source_t()
+  {
+    PYW_GIL_GET;
+    provider = ref_t();
+  }
+
+  virtual size_t count() { return nlines; }
+
+  virtual bool get_line(simpleline_t *out, size_t n)
+  {
+    if ( n >= nlines )
+      return false;
+    size_t pgno = n / page_size;
+    pages_t::iterator p = pages.find(pgno);
+    page_t *pg = p != pages.end() ? &p->second : fetch_page(pgno);
+    if ( pg == NULL )
+      return false;
+    pg->last_use = ++use_counter;
+    size_t idx = n - pgno * page_size;
+    if ( idx >= pg->lines.size() )
+      return false;
+    *out = pg->lines[idx];
+    return true;
+  }
+
+  virtual void set_count(size_t n)
+  {
+    // the last page may have been incomplete
+    if ( nlines > 0 )
+      pages.erase((nlines - 1) / page_size);
+    nlines = n;
+  }
+
+  virtual void invalidate(size_t start, size_t end)
+  {
+    if ( start >= end )
+      return;
+    pages_t::iterator p = pages.lower_bound(start / page_size);
+    size_t last = (end - 1) / page_size;
+    while ( p != pages.end() && p->first <= last )
+      pages.erase(p++);
+  }
+};
+
+//---------------------------------------------------------------------------
+// A read-only mapping of a whole file
+class mapped_file_t
+{
+  mapped_file_handle_t *handle;
+  const char *base;
+  size_t size;
+
+public:
+  mapped_file_t() : handle(NULL), base(NULL), size(0) {}
+  ~mapped_file_t() { close(); }
+
+  const char *begin() const { return base; }
+  size_t length() const { return size; }
+
+  bool open(const char *path)
+  {
+    close();
+    handle = idapython_map_file(&base, &size, path);
+    return handle != NULL;
+  }
+
+  void close()
+  {
+    if ( handle != NULL )
+      idapython_unmap_file(handle);
+    handle = NULL;
+    base = NULL;
+    size = 0;
+  }
+};
+
+//---------------------------------------------------------------------------
+// Lines of a text file, rendered straight from a mapping of the file.
+// A background thread finds the line boundaries; only the start of every
+// MFL_LINES_PER_MARK-th line is remembered, the lines in between are
+// found again when they are displayed. The memory use is thus a small
+// fraction of the file size, and the lines are available as soon as the
+// indexer reaches them.
+#define MFL_LINES_PER_MARK 32
+#define MFL_MAX_LINE_LEN   4096
+class mapped_file_source_t : public lazyline_source_t
+{
+  mapped_file_t file;
+  qmutex_t lock;
+  qvector<uint64> marks;  // protected by 'lock'
+  size_t nlines;          // protected by 'lock'
+  bool done;              // protected by 'lock'
+  volatile bool stop;
+  qthread_t thread;
+
+  static int idaapi index_cb(void *ud)
+  {
+    ((mapped_file_source_t *) ud)->build_index();
+    return 0;
+  }
+
+  void build_index()
+  {
+    const char *base = file.begin();
+    size_t size = file.length();
+    qvector<uint64> batch;
+    size_t pos = 0;
+    size_t n = 0;
+    while ( pos < size && !stop )
+    {
+      if ( n % MFL_LINES_PER_MARK == 0 )
+        batch.push_back(pos);
+      const char *nl = (const char *) memchr(base + pos, '\n', size - pos);
+      pos = nl == NULL ? size : nl - base + 1;
+      ++n;
+      if ( (n & 0xFFFF) == 0 )
+        publish(&batch, n, false);
+    }
+    publish(&batch, n, true);
+  }
+
+  void publish(qvector<uint64> *batch, size_t n, bool finished)
+  {
+    qmutex_lock(lock);
+    marks.insert(marks.end(), batch->begin(), batch->end());
+    nlines = n;
+    done = finished;
+    qmutex_unlock(lock);
+    batch->qclear();
+  }
+
+public:
+  mapped_file_source_t()
+    : nlines(0), done(false), stop(false), thread(NULL)
+  {
+    lock = qmutex_create();
+  }
+
+  ~mapped_file_source_t()
+  {
+    stop = true;
+    if ( thread != NULL )
+    {
+      qthread_join(thread);
+      qthread_free(thread);
+    }
+    qmutex_free(lock);
+  }
+
+  // map the file and start indexing it
+  bool open(const char *path)
+  {
+    if ( !file.open(path) )
+      return false;
+    thread = qthread_create(index_cb, this);
+    if ( thread == NULL )
+      build_index();
+    return true;
+  }
+
+  virtual bool get_progress(size_t *n, bool *finished)
+  {
+    qmutex_lock(lock);
+    *n = nlines;
+    *finished = done;
+    qmutex_unlock(lock);
+    return true;
+  }
+
+  virtual size_t count()
+  {
+    size_t n;
+    bool finished;
+    get_progress(&n, &finished);
+    return n;
+  }
+
+  virtual bool get_line(simpleline_t *out, size_t n)
+  {
+    qmutex_lock(lock);
+    bool ok = n < nlines;
+    uint64 pos = ok ? marks[n / MFL_LINES_PER_MARK] : 0;
+    qmutex_unlock(lock);
+    if ( !ok )
+      return false;
+    const char *p = file.begin() + size_t(pos);
+    const char *end = file.begin() + file.length();
+    for ( size_t skip = n % MFL_LINES_PER_MARK; skip > 0; --skip )
+    {
+      const char *nl = (const char *) memchr(p, '\n', end - p);
+      if ( nl == NULL )
+        return false;
+      p = nl + 1;
+    }
+    const char *eol = (const char *) memchr(p, '\n', end - p);
+    if ( eol == NULL )
+      eol = end;
+    if ( eol > p && eol[-1] == '\r' )
+      --eol;
+    size_t len = qmin(size_t(eol - p), size_t(MFL_MAX_LINE_LEN));
+    out->line.qclear();
+    out->line.append(p, len);
+    // the raw text must not be taken for color tags
+    for ( size_t i = 0; i < len; ++i )
+    {
+      char &c = out->line[i];
+      if ( c == COLOR_ON || c == COLOR_OFF || c == COLOR_ESC || c == COLOR_INV || c == '\0' )
+        c = ' ';
+    }
+    return true;
+  }
+};
+
 //</code(py_kernwin_custview)>
 
 //---------------------------------------------------------------------------
@@ -845,6 +1382,92 @@ PyObject *pyscv_init(PyObject *py_link, const char *title)
 }
 #define DECL_THIS py_simplecustview_t *_this = py_simplecustview_t::get_this(py_this)
 
+//--------------------------------------------------------------------------
+PyObject *pyscv_init_lazy(
+        PyObject *py_link,
+        const char *title,
+        size_t nlines,
+        PyObject *py_provider,
+        size_t page_size,
+        size_t max_pages)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  if ( !PyCallable_Check(py_provider) )
+    Py_RETURN_NONE;
+  py_simplecustview_t *_this = new py_simplecustview_t();
+  lazyline_source_t *src = new py_lazyline_source_t(py_provider, nlines, page_size, max_pages);
+  if ( !_this->init_lazy(py_link, title, src) )
+  {
+    delete _this;
+    Py_RETURN_NONE;
+  }
+  return _this->get_pythis();
+}
+
+//--------------------------------------------------------------------------
+PyObject *pyscv_init_file(PyObject *py_link, const char *title, const char *path)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  mapped_file_source_t *src = new mapped_file_source_t();
+  if ( !src->open(path) )
+  {
+    delete src;
+    Py_RETURN_NONE;
+  }
+  py_simplecustview_t *_this = new py_simplecustview_t();
+  if ( !_this->init_lazy(py_link, title, src) )
+  {
+    delete _this;
+    Py_RETURN_NONE;
+  }
+  return _this->get_pythis();
+}
+
+//--------------------------------------------------------------------------
+// Returns (number of lines, indexing finished), or None if the view
+// is not displaying a file, or was closed
+PyObject *pyscv_update_file_view(PyObject *py_this)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  DECL_THIS;
+  if ( _this == NULL || _this->get_widget() == NULL || _this->get_source() == NULL )
+    Py_RETURN_NONE;
+  size_t n;
+  bool finished;
+  if ( !_this->get_source()->get_progress(&n, &finished) )
+    Py_RETURN_NONE;
+  _this->update_range();
+  return Py_BuildValue("(" PY_BV_SZ "O)", bvsz_t(n), finished ? Py_True : Py_False);
+}
+
+//--------------------------------------------------------------------------
+bool pyscv_set_line_count(PyObject *py_this, size_t nlines)
+{
+  DECL_THIS;
+  if ( _this == NULL )
+    return false;
+  lazyline_source_t *src = _this->get_source();
+  if ( src == NULL )
+    return false;
+  src->set_count(nlines);
+  _this->update_range();
+  return true;
+}
+
+//--------------------------------------------------------------------------
+bool pyscv_invalidate_lines(PyObject *py_this, size_t start, size_t end)
+{
+  DECL_THIS;
+  if ( _this == NULL )
+    return false;
+  lazyline_source_t *src = _this->get_source();
+  if ( src == NULL )
+    return false;
+  src->invalidate(start, end);
+  _this->refresh();
+  return true;
+}
+
 //--------------------------------------------------------------------------
 bool pyscv_refresh(PyObject *py_this)
 {
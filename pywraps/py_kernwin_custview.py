@@ -54,6 +54,81 @@ class simplecustviewer_t(object):
         self.__this = _ida_kernwin.pyscv_init(self, title)
         return True if self.__this else False
 
+    def CreateVirtual(self, title, count, get_lines, page_size=256, max_pages=64):
+        """
+        Creates a custom view whose lines are not stored in the view, but
+        requested when they are displayed. Use it instead of Create() for
+        views with a large number of lines.
+
+        The lines are fetched a page at a time, and at most 'max_pages'
+        pages are kept (the least recently used ones are forgotten first).
+        Lines cannot be added, edited or removed with the *Line() methods:
+        use SetLineCount() and InvalidateLines() instead.
+
+        @param title: The title of the view
+        @param count: The number of lines
+        @param get_lines: A callable get_lines(start, count) returning a list
+                          of 'count' lines, starting at line 'start'.
+                          A line is either a string, or a tuple
+                          (line, fgcolor, bgcolor) like in AddLine().
+                          If it fails, the lines are displayed empty
+                          until they are passed to InvalidateLines()
+        @param page_size: The number of lines requested at once
+        @param max_pages: The number of pages kept
+        @return: Boolean whether it succeeds or fails
+        """
+        self.title = title
+        self.__this = _ida_kernwin.pyscv_init_lazy(self, title, count, get_lines, page_size, max_pages)
+        return True if self.__this else False
+
+    def CreateFromFile(self, title, path, poll_interval=250):
+        """
+        Creates a custom view displaying the lines of a text file.
+        The file is mapped in memory, and the lines are displayed
+        straight from the mapping: opening even a very large file is
+        immediate. The lines are indexed in the background; the view
+        grows as they become available.
+
+        The view is read-only, like views created by CreateVirtual().
+
+        @param title: The title of the view
+        @param path: The path of the file
+        @param poll_interval: How often (in milliseconds) the view is
+                              updated while the file is being indexed
+        @return: Boolean whether it succeeds or fails
+        """
+        self.title = title
+        self.__this = _ida_kernwin.pyscv_init_file(self, title, path)
+        if not self.__this:
+            return False
+        def poll():
+            if not self.__this:
+                return -1
+            # None: the view was closed, stop polling
+            r = _ida_kernwin.pyscv_update_file_view(self.__this)
+            return -1 if r is None or r[1] else poll_interval
+        if poll() != -1:
+            register_timer(poll_interval, poll)
+        return True
+
+    def SetLineCount(self, count):
+        """
+        Sets the number of lines of a view created by CreateVirtual()
+        @return: Boolean
+        """
+        return _ida_kernwin.pyscv_set_line_count(self.__this, count)
+
+    def InvalidateLines(self, start=0, end=-1):
+        """
+        Forgets the lines [start, end) of a view created by CreateVirtual().
+        They will be requested again the next time they are displayed.
+        @param end: -1 means up to the last line
+        @return: Boolean
+        """
+        if end < 0:
+            end = self.Count()
+        return _ida_kernwin.pyscv_invalidate_lines(self.__this, start, end)
+
     def Close(self):
         """
         Destroys the view.
@@ -4,6 +4,40 @@
 //<code(py_lines)>
 //------------------------------------------------------------------------
 static PyObject *py_get_user_defined_prefix = NULL;
+
+// The prefixes pushed with set_user_defined_prefix_range(s)(), and
+// the cached results of the Python callback (see UDPF_CACHE).
+// The paint path doesn't call into Python when any of them can be used.
+struct udp_key_t
+{
+  ea_t ea;
+  int lnnum;
+  int indent;
+  udp_key_t(ea_t _ea, int _lnnum, int _indent)
+    : ea(_ea), lnnum(_lnnum), indent(_indent) {}
+  bool operator<(const udp_key_t &r) const
+  {
+    if ( ea != r.ea )
+      return ea < r.ea;
+    if ( lnnum != r.lnnum )
+      return lnnum < r.lnnum;
+    return indent < r.indent;
+  }
+};
+typedef std::map<udp_key_t, qstring> udp_cache_t;
+static udp_cache_t udp_cache;
+static ea_interval_map_t<qstring> udp_ranges;
+static bool udp_use_ranges = false; // UDPF_RANGES
+static bool udp_use_cache = false;  // UDPF_CACHE
+static const size_t UDP_CACHE_MAXSIZE = 0x10000;
+
+static void clear_user_defined_prefixes(void)
+{
+  udp_cache.clear();
+  udp_ranges.clear();
+}
+
+//------------------------------------------------------------------------
 static void idaapi s_py_get_user_defined_prefix(
         qstring *buf,
         ea_t ea,
@@ -11,6 +45,32 @@ static void idaapi s_py_get_user_defined_prefix(
         int indent,
         const char *line)
 {
+  // pushed prefixes are for the lines of the items themselves
+  if ( udp_use_ranges && indent == -1 )
+  {
+    const qstring *pfx = udp_ranges.find(ea);
+    if ( pfx != NULL )
+    {
+      *buf = *pfx;
+      return;
+    }
+  }
+
+  udp_key_t key(ea, lnnum, indent);
+  if ( udp_use_cache )
+  {
+    udp_cache_t::const_iterator p = udp_cache.find(key);
+    if ( p != udp_cache.end() )
+    {
+      *buf = p->second;
+      return;
+    }
+  }
+
+  buf->qclear();
+  if ( py_get_user_defined_prefix == NULL )
+    return;
+
   PYW_GIL_GET;
   newref_t py_ret(
           PyObject_CallFunction(
@@ -30,6 +90,25 @@ static void idaapi s_py_get_user_defined_prefix(
       buf->append(py_str, py_len);
     }
   }
+
+  if ( udp_use_cache )
+  {
+    if ( udp_cache.size() >= UDP_CACHE_MAXSIZE )
+      udp_cache.clear();
+    udp_cache[key] = *buf;
+  }
+}
+
+//-------------------------------------------------------------------------
+static void ida_lines_term(void)
+{
+  clear_user_defined_prefixes();
+}
+
+//-------------------------------------------------------------------------
+static void ida_lines_closebase(void)
+{
+  clear_user_defined_prefixes();
 }
 //</code(py_lines)>
 
@@ -40,7 +119,7 @@ static void idaapi s_py_get_user_defined_prefix(
 //------------------------------------------------------------------------
 /*
 #<pydoc>
-def set_user_defined_prefix(width, callback):
+def set_user_defined_prefix(width, callback, flags=0):
     """
     User-defined line-prefixes are displayed just after the autogenerated
     line prefixes. In order to use them, the plugin should call the
@@ -55,34 +134,53 @@ def set_user_defined_prefix(width, callback):
           line   - the line to be generated. the line usually contains color tags this argument
                    can be examined to decide whether to generated the prefix
         It returns a buffer of size < bufsize
+    @param flags: combination of UDPF_... flags:
+        UDPF_CACHE  - the prefix only depends on (ea, lnnum, indent): the
+                      results of the callback are cached, and the callback
+                      is only called for lines that are not in the cache.
+                      Use invalidate_user_defined_prefixes() when the
+                      prefixes must be computed again.
+        UDPF_RANGES - the prefixes pushed with set_user_defined_prefix_range()
+                      are used for the lines of the items in these ranges,
+                      without calling the callback. The callback can
+                      then be None.
 
     In order to remove the callback before unloading the plugin, specify the width = 0 or the callback = None
+    (without UDPF_RANGES)
     """
     pass
 #</pydoc>
 */
-static PyObject *py_set_user_defined_prefix(size_t width, PyObject *pycb)
+#define UDPF_CACHE  0x0001
+#define UDPF_RANGES 0x0002
+static PyObject *py_set_user_defined_prefix(size_t width, PyObject *pycb, int flags=0)
 {
   PYW_GIL_CHECK_LOCKED_SCOPE();
-  if ( width == 0 || pycb == Py_None )
+  if ( width == 0 || (pycb == Py_None && (flags & UDPF_RANGES) == 0) )
   {
     // Release old callback reference
     Py_XDECREF(py_get_user_defined_prefix);
 
     // ...and clear it
     py_get_user_defined_prefix = NULL;
+    udp_use_ranges = false;
+    udp_use_cache = false;
+    udp_cache.clear();
 
     // Uninstall user defind prefix
     set_user_defined_prefix(0, NULL);
   }
-  else if ( PyCallable_Check(pycb) )
+  else if ( pycb == Py_None || PyCallable_Check(pycb) )
   {
     // Release old callback reference
     Py_XDECREF(py_get_user_defined_prefix);
 
     // Copy new callback and hold a reference
-    py_get_user_defined_prefix = pycb;
-    Py_INCREF(py_get_user_defined_prefix);
+    py_get_user_defined_prefix = pycb == Py_None ? NULL : pycb;
+    Py_XINCREF(py_get_user_defined_prefix);
+    udp_use_ranges = (flags & UDPF_RANGES) != 0;
+    udp_use_cache = (flags & UDPF_CACHE) != 0;
+    udp_cache.clear();
 
     set_user_defined_prefix(width, s_py_get_user_defined_prefix);
   }
@@ -93,6 +191,118 @@ static PyObject *py_set_user_defined_prefix(size_t width, PyObject *pycb)
   Py_RETURN_TRUE;
 }
 
+//-------------------------------------------------------------------------
+/*
+#<pydoc>
+def set_user_defined_prefix_range(start, end, prefix):
+    """
+    Set the user-defined prefix of the items in [start, end)
+    (see UDPF_RANGES). It replaces the prefixes previously set
+    for that range, if any.
+    @param prefix: the prefix, or None to remove the prefixes of the range
+    """
+    pass
+#</pydoc>
+*/
+static PyObject *py_set_user_defined_prefix_range(ea_t start, ea_t end, PyObject *py_prefix)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  if ( py_prefix == Py_None )
+  {
+    udp_ranges.erase(start, end);
+  }
+  else
+  {
+    Py_ssize_t py_len;
+    char *py_str;
+    if ( PyString_AsStringAndSize(py_prefix, &py_str, &py_len) == -1 )
+      return NULL;
+    udp_ranges.set(start, end, qstring(py_str, py_len));
+  }
+  Py_RETURN_NONE;
+}
+
+//-------------------------------------------------------------------------
+/*
+#<pydoc>
+def set_user_defined_prefix_ranges(ranges):
+    """
+    Set the user-defined prefixes of many ranges at once, e.g., to
+    display a coverage map (see UDPF_RANGES).
+    @param ranges: a list of (start, end, prefix) tuples, applied in order.
+                   A None prefix removes the prefixes of the range.
+    @return: the number of ranges that were applied
+    """
+    pass
+#</pydoc>
+*/
+static PyObject *py_set_user_defined_prefix_ranges(PyObject *py_ranges)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  struct ida_local lambda_t
+  {
+    static int idaapi cvt(const ref_t &py_item, Py_ssize_t /*i*/, void *)
+    {
+      bvea_t start, end;
+      PyObject *py_prefix;
+      if ( !PyArg_ParseTuple(py_item.o, PY_BV_EA PY_BV_EA "O", &start, &end, &py_prefix) )
+        return CIP_FAILED;
+      if ( py_prefix == Py_None )
+      {
+        udp_ranges.erase(ea_t(start), ea_t(end));
+        return CIP_OK;
+      }
+      Py_ssize_t py_len;
+      char *py_str;
+      if ( PyString_AsStringAndSize(py_prefix, &py_str, &py_len) == -1 )
+        return CIP_FAILED;
+      udp_ranges.set(ea_t(start), ea_t(end), qstring(py_str, py_len));
+      return CIP_OK;
+    }
+  };
+  Py_ssize_t n = pyvar_walk_list(py_ranges, lambda_t::cvt);
+  if ( n < 0 )
+  {
+    if ( !PyErr_Occurred() )
+      PyErr_SetString(PyExc_TypeError, "expected a list of (start, end, prefix) tuples");
+    return NULL;
+  }
+  return PyInt_FromSsize_t(n);
+}
+
+//-------------------------------------------------------------------------
+/*
+#<pydoc>
+def clear_user_defined_prefix_ranges():
+    """
+    Remove all the prefixes set with set_user_defined_prefix_range(s)()
+    """
+    pass
+#</pydoc>
+*/
+static void clear_user_defined_prefix_ranges(void)
+{
+  udp_ranges.clear();
+}
+
+//-------------------------------------------------------------------------
+/*
+#<pydoc>
+def invalidate_user_defined_prefixes(ea1=0, ea2=BADADDR):
+    """
+    Forget the cached prefixes of [ea1, ea2) (see UDPF_CACHE), so that
+    the callback is called again when those lines are displayed.
+    """
+    pass
+#</pydoc>
+*/
+static void invalidate_user_defined_prefixes(ea_t ea1=0, ea_t ea2=BADADDR)
+{
+  udp_cache_t::iterator p = udp_cache.lower_bound(udp_key_t(ea1, INT_MIN, INT_MIN));
+  while ( p != udp_cache.end() && p->first.ea < ea2 )
+    udp_cache.erase(p++);
+}
+
 //-------------------------------------------------------------------------
 /*
 #<pydoc>
@@ -187,5 +397,171 @@ PyObject *py_generate_disassembly(
   }
   return Py_BuildValue("(iO)", lnnum, py_tuple.o);
 }
+//-------------------------------------------------------------------------
+/*
+#<pydoc>
+class disasm_line_cache_t(object):
+    """
+    A cache of rendered disassembly lines, keyed by (ea, flags).
+    Pass it to generate_disasm_lines() so that rendering the same,
+    unchanged items again is a lookup instead of a new rendering.
+
+    The cache listens to IDB events for as long as it lives:
+    changes local to an item (bytes, comments, operand types, colors,
+    item creation/deletion) drop the entries for that item, and any
+    other database change (names, functions, segments, types,
+    repeatable comments, ...) drops all entries. Changes to the display options are not
+    reported by IDB events; call clear() after modifying them.
+    """
+    def __init__(self, maxsize=0):
+        """
+        @param maxsize: maximum number of cached lines (0 means no limit).
+                        The cache is emptied when it reaches that size.
+        """
+        pass
+    def clear(self):
+        """Drop all the cached lines"""
+        pass
+    def size(self):
+        """Number of cached lines"""
+        pass
+    def hits(self):
+        """Number of lines that were found in the cache"""
+        pass
+    def misses(self):
+        """Number of lines that had to be rendered"""
+        pass
+#</pydoc>
+*/
+class disasm_line_cache_t
+{
+  typedef std::pair<ea_t, int> key_t;
+  typedef std::map<key_t, qstring> lines_t;
+  lines_t lines;
+  size_t maxsize;
+  size_t nhits;
+  size_t nmisses;
+
+  void del_range(ea_t ea1, ea_t ea2)
+  {
+    lines_t::iterator p = lines.lower_bound(key_t(ea1, INT_MIN));
+    while ( p != lines.end() && p->first.first < ea2 )
+      lines.erase(p++);
+  }
+
+  static ssize_t idaapi on_idb_event(void *ud, int code, va_list va)
+  {
+    disasm_line_cache_t *_this = (disasm_line_cache_t *) ud;
+    if ( _this->lines.empty() )
+      return 0;
+    ea_t ea1;
+    ea_t ea2;
+    switch ( classify_idb_event(&ea1, &ea2, code, va) )
+    {
+      case IDBCH_NONE:
+        break;
+      case IDBCH_COLOR:
+      case IDBCH_ITEMS:
+        _this->del_range(ea1, ea2);
+        break;
+      // a function change (e.g., to its frame) can change any of its
+      // lines, and the lines of its chunks are not contiguous
+      case IDBCH_FUNC:
+      case IDBCH_ALL:
+        _this->lines.clear();
+        break;
+    }
+    return 0;
+  }
+
+public:
+  disasm_line_cache_t(size_t _maxsize=0)
+    : maxsize(_maxsize), nhits(0), nmisses(0)
+  {
+    idapython_hook_to_notification_point(HT_IDB, on_idb_event, this);
+  }
+
+  ~disasm_line_cache_t()
+  {
+    idapython_unhook_from_notification_point(HT_IDB, on_idb_event, this);
+  }
+
+  void clear() { lines.clear(); }
+  size_t size() const { return lines.size(); }
+  size_t hits() const { return nhits; }
+  size_t misses() const { return nmisses; }
+
+  // Render the line at 'ea', or fetch it from the cache
+  void render(qstring *out, ea_t ea, int flags)
+  {
+    key_t key(ea, flags);
+    lines_t::const_iterator p = lines.find(key);
+    if ( p != lines.end() )
+    {
+      ++nhits;
+      *out = p->second;
+      return;
+    }
+    ++nmisses;
+    if ( !generate_disasm_line(out, ea, flags) )
+      out->qclear();
+    if ( maxsize != 0 && lines.size() >= maxsize )
+      lines.clear();
+    lines[key] = *out;
+  }
+};
+
+//-------------------------------------------------------------------------
+/*
+#<pydoc>
+def generate_disasm_lines(eas, flags=0, cache=None):
+    """
+    Render the disassembly lines of a list of addresses in one call.
+    This is equivalent to calling generate_disasm_line() for each address.
+
+    @param eas: a list of addresses
+    @param flags: combination of the GENDSM_ flags, or 0
+    @param cache: an optional disasm_line_cache_t. Lines already in the
+                  cache are not rendered again, and the rendered ones
+                  are added to it.
+    @return: a list of lines (with color tags), in the same order as
+             'eas'. Addresses that could not be rendered yield ''.
+    """
+    pass
+#</pydoc>
+*/
+static PyObject *py_generate_disasm_lines(
+        const eavec_t &eas,
+        int flags=0,
+        disasm_line_cache_t *cache=NULL)
+{
+  qstrvec_t lines;
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  size_t n = eas.size();
+  lines.resize(n);
+  if ( cache != NULL )
+  {
+    // the cache is not thread-safe: keep the GIL, so that no other
+    // Python thread can use it at the same time
+    for ( size_t i = 0; i < n; ++i )
+      cache->render(&lines[i], eas[i], flags);
+  }
+  else
+  {
+    Py_BEGIN_ALLOW_THREADS;
+    for ( size_t i = 0; i < n; ++i )
+      if ( !generate_disasm_line(&lines[i], eas[i], flags) )
+        lines[i].qclear();
+    Py_END_ALLOW_THREADS;
+  }
+  newref_t py_list(PyList_New(n));
+  for ( size_t i = 0; i < n; ++i )
+  {
+    const qstring &l = lines[i];
+    PyList_SetItem(py_list.o, i, PyString_FromStringAndSize(l.c_str(), l.length()));
+  }
+  py_list.incref();
+  return py_list.o;
+}
 //</inline(py_lines)>
 #endif
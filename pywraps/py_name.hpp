@@ -43,4 +43,257 @@ PyObject *py_validate_name(const char *name, nametype_t type, int flags=0)
   else
     Py_RETURN_NONE;
 }
+
+//-------------------------------------------------------------------------
+/*
+#<pydoc>
+def get_nlist_entries():
+    """
+    Get the whole names list at once.
+    This is what idautils.Names() uses, rather than querying
+    get_nlist_ea() and get_nlist_name() for each index.
+
+    @return: a list of (ea, name) tuples
+    """
+    pass
+#</pydoc>
+*/
+PyObject *get_nlist_entries()
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  size_t n = get_nlist_size();
+  newref_t py_list(PyList_New(n));
+  for ( size_t i = 0; i < n; ++i )
+    PyList_SET_ITEM(py_list.o, i, Py_BuildValue("(" PY_BV_EA "s)", bvea_t(get_nlist_ea(i)), get_nlist_name(i)));
+  py_list.incref();
+  return py_list.o;
+}
+
+//-------------------------------------------------------------------------
+/*
+#<pydoc>
+class name_index_t(object):
+    """
+    A native index of the names list (see get_nlist_ea()/get_nlist_name()),
+    offering ea->name and name->ea lookups, prefix queries and bulk export.
+
+    The index is built when the object is created, and then kept current
+    by listening to IDB events (renamed items, destroyed items, deleted
+    segments); there is no need to rescan the names list after such
+    changes. When the database is closed, the index is emptied, and
+    rebuilt the first time it is used with the next database.
+    """
+    def __init__(self):
+        pass
+    def rebuild(self):
+        """Rescan the whole names list"""
+        pass
+    def size(self):
+        """Number of indexed names"""
+        pass
+    def get_name(self, ea):
+        """@return: the name at 'ea', or None"""
+        pass
+    def get_ea(self, name):
+        """@return: the address of 'name', or BADADDR"""
+        pass
+    def get_eas(self, names):
+        """
+        Look up a list of names at once
+        @return: a list of addresses (BADADDR for unknown names)
+        """
+        pass
+    def find_prefix(self, prefix, maxcnt=0):
+        """
+        Find the names starting with 'prefix'
+        @param maxcnt: maximum number of results (0 means no limit)
+        @return: a list of (ea, name) tuples, sorted by name
+        """
+        pass
+    def export_names(self):
+        """@return: a list of all (ea, name) tuples, sorted by address"""
+        pass
+#</pydoc>
+*/
+class name_index_t
+{
+  typedef std::map<ea_t, qstring> ea2name_t;
+  typedef std::map<qstring, ea_t> name2ea_t;
+  ea2name_t ea2name;
+  name2ea_t name2ea;
+  bool stale;   // the database was closed: rebuild on first use
+
+  void del_name_at(ea_t ea)
+  {
+    ea2name_t::iterator p = ea2name.find(ea);
+    if ( p == ea2name.end() )
+      return;
+    name2ea.erase(p->second);
+    ea2name.erase(p);
+  }
+
+  void set_name_at(ea_t ea, const char *name)
+  {
+    del_name_at(ea);
+    ea2name[ea] = name;
+    name2ea[name] = ea;
+  }
+
+  // check the indexed names in [ea1, ea2) against the names list
+  void recheck_range(ea_t ea1, ea_t ea2)
+  {
+    ea2name_t::iterator p = ea2name.lower_bound(ea1);
+    while ( p != ea2name.end() && p->first < ea2 )
+    {
+      ea_t ea = (p++)->first;
+      qstring name;
+      if ( !is_in_nlist(ea) || ::get_name(&name, ea) <= 0 )
+        del_name_at(ea);
+      else
+        set_name_at(ea, name.c_str());
+    }
+  }
+
+  void ensure_current()
+  {
+    if ( stale )
+      rebuild();
+  }
+
+  static ssize_t idaapi on_idb_event(void *ud, int code, va_list va)
+  {
+    name_index_t *_this = (name_index_t *) ud;
+    if ( _this->stale )
+      return 0;
+    switch ( code )
+    {
+      case idb_event::renamed:
+        {
+          ea_t ea = va_arg(va, ea_t);
+          const char *new_name = va_arg(va, const char *);
+          // only the names list is indexed (no local, dummy or SN_NOLIST names)
+          if ( new_name == NULL || new_name[0] == '\0' || !is_in_nlist(ea) )
+            _this->del_name_at(ea);
+          else
+            _this->set_name_at(ea, new_name);
+        }
+        break;
+      case idb_event::destroyed_items:
+        {
+          ea_t ea1 = va_arg(va, ea_t);
+          ea_t ea2 = va_arg(va, ea_t);
+          _this->recheck_range(ea1, ea2);
+        }
+        break;
+      case idb_event::deleting_segm:
+        {
+          // the names of the segment go away with it
+          segment_t *s = getseg(va_arg(va, ea_t));
+          if ( s != NULL )
+          {
+            ea2name_t::iterator p = _this->ea2name.lower_bound(s->start_ea);
+            while ( p != _this->ea2name.end() && p->first < s->end_ea )
+              _this->del_name_at((p++)->first);
+          }
+        }
+        break;
+      case idb_event::closebase:
+        _this->ea2name.clear();
+        _this->name2ea.clear();
+        _this->stale = true;
+        break;
+    }
+    return 0;
+  }
+
+public:
+  name_index_t() : stale(false)
+  {
+    rebuild();
+    idapython_hook_to_notification_point(HT_IDB, on_idb_event, this);
+  }
+
+  ~name_index_t()
+  {
+    idapython_unhook_from_notification_point(HT_IDB, on_idb_event, this);
+  }
+
+  void rebuild()
+  {
+    ea2name.clear();
+    name2ea.clear();
+    for ( size_t i = 0, n = get_nlist_size(); i < n; ++i )
+      set_name_at(get_nlist_ea(i), get_nlist_name(i));
+    stale = false;
+  }
+
+  size_t size()
+  {
+    ensure_current();
+    return ea2name.size();
+  }
+
+  PyObject *get_name(ea_t ea)
+  {
+    PYW_GIL_CHECK_LOCKED_SCOPE();
+    ensure_current();
+    ea2name_t::const_iterator p = ea2name.find(ea);
+    if ( p == ea2name.end() )
+      Py_RETURN_NONE;
+    return PyString_FromStringAndSize(p->second.c_str(), p->second.length());
+  }
+
+  ea_t get_ea(const char *name)
+  {
+    ensure_current();
+    name2ea_t::const_iterator p = name2ea.find(name);
+    return p == name2ea.end() ? BADADDR : p->second;
+  }
+
+  PyObject *get_eas(PyObject *py_names)
+  {
+    PYW_GIL_CHECK_LOCKED_SCOPE();
+    qstrvec_t names;
+    if ( PyW_PyListToStrVec(&names, py_names) < 0 )
+      return NULL;
+    eavec_t eas;
+    eas.reserve(names.size());
+    for ( size_t i = 0, n = names.size(); i < n; ++i )
+      eas.push_back(get_ea(names[i].c_str()));
+    ref_t result(PyW_UvalVecToPyList(eas));
+    result.incref();
+    return result.o;
+  }
+
+  PyObject *find_prefix(const char *prefix, size_t maxcnt=0)
+  {
+    PYW_GIL_CHECK_LOCKED_SCOPE();
+    ensure_current();
+    size_t plen = qstrlen(prefix);
+    newref_t py_list(PyList_New(0));
+    for ( name2ea_t::const_iterator p = name2ea.lower_bound(prefix);
+          p != name2ea.end() && strncmp(p->first.c_str(), prefix, plen) == 0;
+          ++p )
+    {
+      if ( maxcnt != 0 && PyList_GET_SIZE(py_list.o) >= Py_ssize_t(maxcnt) )
+        break;
+      newref_t py_item(Py_BuildValue("(" PY_BV_EA "s)", bvea_t(p->second), p->first.c_str()));
+      PyList_Append(py_list.o, py_item.o);
+    }
+    py_list.incref();
+    return py_list.o;
+  }
+
+  PyObject *export_names()
+  {
+    PYW_GIL_CHECK_LOCKED_SCOPE();
+    ensure_current();
+    newref_t py_list(PyList_New(ea2name.size()));
+    Py_ssize_t i = 0;
+    for ( ea2name_t::const_iterator p = ea2name.begin(); p != ea2name.end(); ++p, ++i )
+      PyList_SET_ITEM(py_list.o, i, Py_BuildValue("(" PY_BV_EA "s)", bvea_t(p->first), p->second.c_str()));
+    py_list.incref();
+    return py_list.o;
+  }
+};
 //</inline(py_name)>
@@ -5,19 +5,13 @@
 //-------------------------------------------------------------------------
 PyObject *idc_parse_decl(til_t *ti, const char *decl, int flags)
 {
-  tinfo_t tif;
-  qstring name;
-  qtype fields, type;
-  bool ok = parse_decl(&tif, &name, ti, decl, flags);
-  if ( ok )
-    ok = tif.serialize(&type, &fields, NULL, SUDT_FAST);
-
   PYW_GIL_CHECK_LOCKED_SCOPE();
-  if ( ok )
+  parsed_decl_t pd;
+  if ( parse_decl_cached(&pd, ti, decl, flags) )
     return Py_BuildValue("(sss)",
-                         name.c_str(),
-                         (char *)type.c_str(),
-                         (char *)fields.c_str());
+                         pd.name.c_str(),
+                         (char *)pd.type.c_str(),
+                         (char *)pd.fields.c_str());
   Py_RETURN_NONE;
 }
 
@@ -44,10 +38,11 @@ PyObject *py_calc_type_size(const til_t *ti, PyObject *tp)
     // To avoid release of 'data' during Py_BEGIN|END_ALLOW_THREADS section.
     borref_t tpref(tp);
     const type_t *data = (type_t *)PyString_AsString(tp);
+    tinfo_t tif;
+    if ( !deserialize_cached(&tif, ti, data, NULL) )
+      Py_RETURN_NONE;
     size_t sz;
     Py_BEGIN_ALLOW_THREADS;
-    tinfo_t tif;
-    tif.deserialize(ti, &data, NULL, NULL);
     sz = tif.get_size();
     Py_END_ALLOW_THREADS;
     if ( sz != BADSIZE )
@@ -87,39 +82,53 @@ static bool py_apply_type(til_t *ti, PyObject *py_type, PyObject *py_fields, ea_
   }
   const type_t *type   = (const type_t *) PyString_AsString(py_type);
   const p_list *fields = PyW_Fields(py_fields);
+  bool del = type[0] == '\0';
+  tinfo_t tif;
+  if ( !del && !deserialize_cached(&tif, ti, type, fields) )
+    return false;
   bool rc;
   Py_BEGIN_ALLOW_THREADS;
-  struc_t *sptr;
-  member_t *mptr = get_member_by_id(ea, &sptr);
-  if ( type[0] == '\0' )
-  {
-    if ( mptr != NULL )
-    {
-      rc = mptr->has_ti();
-      if ( rc )
-        del_member_tinfo(sptr, mptr);
-    }
-    else
-    {
-      rc = has_ti(ea);
-      if ( rc )
-        del_tinfo(ea);
-    }
-  }
-  else
+  rc = apply_tinfo_to_ea(ea, del ? NULL : &tif, flags);
+  Py_END_ALLOW_THREADS;
+  return rc;
+}
+
+//-------------------------------------------------------------------------
+/*
+#<pydoc>
+def apply_type_many(ti, targets, flags)
+    """
+    Apply types to many addresses at once.
+    Each distinct type is deserialized only once.
+
+    @param ti: Type info library. 'None' can be used.
+    @param targets: either a list of (ea, py_type, py_fields) tuples,
+                    or a tuple (eas, one_type) where 'eas' is a list of
+                    addresses and 'one_type' is a type string or a
+                    (py_type, py_fields) tuple.
+                    An empty type string removes the type, as with apply_type()
+    @param flags: combination of TINFO_... constants or 0
+    @return: a string holding one bit per target, in order (LSB first),
+             set if the type was applied.
+             See ida_typeinf.apply_type_many_result() to unpack it.
+    """
+    pass
+#</pydoc>
+*/
+static PyObject *py_apply_type_many(til_t *ti, PyObject *targets, int flags)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  apply_targets_t at;
+  if ( !at.init(ti, targets) )
   {
-    tinfo_t tif;
-    rc = tif.deserialize(ti, &type, &fields, NULL);
-    if ( rc )
-    {
-      if ( mptr != NULL )
-        rc = set_member_tinfo(sptr, mptr, 0, tif, 0);
-      else
-        rc = apply_tinfo(ea, tif, flags);
-    }
+    PyErr_SetString(PyExc_ValueError, "Expected a list of (ea, type, fields) or a tuple (eas, type)");
+    return NULL;
   }
+  bytevec_t bitmap;
+  Py_BEGIN_ALLOW_THREADS;
+  at.apply(&bitmap, flags);
   Py_END_ALLOW_THREADS;
-  return rc;
+  return PyString_FromStringAndSize((const char *) bitmap.begin(), bitmap.size());
 }
 
 //-------------------------------------------------------------------------
@@ -182,9 +191,9 @@ PyObject *py_unpack_object_from_idb(
   const p_list *fields = PyW_Fields(py_fields);
   idc_value_t idc_obj;
   error_t err;
-  Py_BEGIN_ALLOW_THREADS;
   tinfo_t tif;
-  tif.deserialize(ti, &type, &fields);
+  deserialize_cached(&tif, ti, type, fields);
+  Py_BEGIN_ALLOW_THREADS;
   err = unpack_idcobj_from_idb(
       &idc_obj,
       tif,
@@ -256,9 +265,9 @@ PyObject *py_unpack_object_from_bv(
 
   idc_value_t idc_obj;
   error_t err;
-  Py_BEGIN_ALLOW_THREADS;
   tinfo_t tif;
-  tif.deserialize(ti, &type, &fields);
+  deserialize_cached(&tif, ti, type, fields);
+  Py_BEGIN_ALLOW_THREADS;
   err = unpack_idcobj_from_bv(
       &idc_obj,
       tif,
@@ -330,9 +339,9 @@ PyObject *py_pack_object_to_idb(
   // Pack
   // error_t err;
   error_t err;
-  Py_BEGIN_ALLOW_THREADS;
   tinfo_t tif;
-  tif.deserialize(ti, &type, &fields);
+  deserialize_cached(&tif, ti, type, fields);
+  Py_BEGIN_ALLOW_THREADS;
   err = pack_idcobj_to_idb(&idc_obj, tif, ea, pio_flags);
   Py_END_ALLOW_THREADS;
   return PyInt_FromLong(err);
@@ -389,9 +398,9 @@ PyObject *py_pack_object_to_bv(
   // Pack
   relobj_t bytes;
   error_t err;
-  Py_BEGIN_ALLOW_THREADS;
   tinfo_t tif;
-  tif.deserialize(ti, &type, &fields);
+  deserialize_cached(&tif, ti, type, fields);
+  Py_BEGIN_ALLOW_THREADS;
   err = pack_idcobj_to_bv(
     &idc_obj,
     tif,
@@ -545,11 +554,14 @@ PyObject *idc_print_type(PyObject *py_type, PyObject *py_fields, const char *nam
   const type_t *type   = (type_t *)PyString_AsString(py_type);
   const p_list *fields = PyW_Fields(py_fields);
   bool ok;
-  Py_BEGIN_ALLOW_THREADS;
   tinfo_t tif;
-  ok = tif.deserialize(NULL, &type, &fields, NULL)
-    && tif.print(&res, name, flags, 2, 40);
-  Py_END_ALLOW_THREADS;
+  ok = deserialize_cached(&tif, NULL, type, fields);
+  if ( ok )
+  {
+    Py_BEGIN_ALLOW_THREADS;
+    ok = tif.print(&res, name, flags, 2, 40);
+    Py_END_ALLOW_THREADS;
+  }
   if ( ok )
     return PyString_FromString(res.begin());
   else
@@ -717,6 +729,267 @@ inline const p_list * PyW_Fields(PyObject *tp)
   return tp == Py_None ? NULL : (const p_list *) PyString_AsString(tp);
 }
 
+//-------------------------------------------------------------------------
+//                       parsed types cache
+//-------------------------------------------------------------------------
+// Declarations parsed by idc_parse_decl(), and type strings deserialized
+// by the functions below, are kept for the rest of the session, so that
+// applying the same type over and over doesn't run the parser each time.
+// Only types of the local type library are cached: other libraries can
+// be freed at any time. The cache is cleared when the local types change.
+// The cache must only be accessed with the GIL held.
+struct parsed_decl_t
+{
+  bool ok;
+  tinfo_t tif;
+  qstring name;
+  qtype type;
+  qtype fields;
+};
+
+struct deserialized_type_t
+{
+  bool ok;
+  tinfo_t tif;
+};
+
+#define TYPE_CACHE_MAXSIZE 4096
+// keyed by (flags, declaration)
+typedef std::map<std::pair<int, qstring>, parsed_decl_t> parsed_decls_t;
+// keyed by (type, fields)
+typedef std::map<std::pair<qstring, qstring>, deserialized_type_t> deserialized_types_t;
+static parsed_decls_t parsed_decls;
+static deserialized_types_t deserialized_types;
+
+//-------------------------------------------------------------------------
+static void clear_type_cache()
+{
+  parsed_decls.clear();
+  deserialized_types.clear();
+}
+
+//-------------------------------------------------------------------------
+static ssize_t idaapi type_cache_on_idb_event(void *, int code, va_list)
+{
+  switch ( code )
+  {
+    case idb_event::local_types_changed:
+    case idb_event::compiler_changed:
+      {
+        PYW_GIL_GET;
+        clear_type_cache();
+      }
+      break;
+  }
+  return 0;
+}
+
+//-------------------------------------------------------------------------
+inline bool type_cache_usable(const til_t *ti)
+{
+  return ti == NULL || ti == get_idati();
+}
+
+//-------------------------------------------------------------------------
+// parse_decl(), followed by serialize(). The result is copied to 'out'.
+static bool parse_decl_cached(parsed_decl_t *out, til_t *ti, const char *decl, int flags)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  std::pair<int, qstring> key(flags, qstring(decl));
+  if ( type_cache_usable(ti) )
+  {
+    parsed_decls_t::iterator p = parsed_decls.find(key);
+    if ( p != parsed_decls.end() )
+    {
+      *out = p->second;
+      return out->ok;
+    }
+  }
+  out->tif.clear();
+  out->name.qclear();
+  out->ok = parse_decl(&out->tif, &out->name, ti, decl, flags)
+         && out->tif.serialize(&out->type, &out->fields, NULL, SUDT_FAST);
+  if ( type_cache_usable(ti) )
+  {
+    if ( parsed_decls.size() >= TYPE_CACHE_MAXSIZE )
+      parsed_decls.clear();
+    parsed_decls[key] = *out;
+  }
+  return out->ok;
+}
+
+//-------------------------------------------------------------------------
+// tinfo_t::deserialize() of a type string and its (possibly NULL) fields
+static bool deserialize_cached(
+        tinfo_t *out,
+        const til_t *ti,
+        const type_t *type,
+        const p_list *fields)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  if ( !type_cache_usable(ti) )
+    return out->deserialize(ti, &type, &fields, NULL);
+  std::pair<qstring, qstring> key(
+          qstring((const char *) type),
+          qstring(fields != NULL ? (const char *) fields : ""));
+  deserialized_types_t::iterator p = deserialized_types.find(key);
+  if ( p == deserialized_types.end() )
+  {
+    if ( deserialized_types.size() >= TYPE_CACHE_MAXSIZE )
+      deserialized_types.clear();
+    deserialized_type_t &dt = deserialized_types[key];
+    dt.ok = dt.tif.deserialize(ti, &type, &fields, NULL);
+    p = deserialized_types.find(key);
+  }
+  *out = p->second.tif;
+  return p->second.ok;
+}
+
+//-------------------------------------------------------------------------
+// Apply 'tif' to a structure member (if 'ea' is a member id) or to an
+// address. A NULL 'tif' removes the type.
+static bool apply_tinfo_to_ea(ea_t ea, const tinfo_t *tif, int flags)
+{
+  struc_t *sptr;
+  member_t *mptr = get_member_by_id(ea, &sptr);
+  if ( tif == NULL )
+  {
+    if ( mptr != NULL )
+    {
+      if ( !mptr->has_ti() )
+        return false;
+      del_member_tinfo(sptr, mptr);
+    }
+    else
+    {
+      if ( !has_ti(ea) )
+        return false;
+      del_tinfo(ea);
+    }
+    return true;
+  }
+  if ( mptr != NULL )
+    return set_member_tinfo(sptr, mptr, 0, *tif, 0);
+  return apply_tinfo(ea, *tif, flags);
+}
+
+//-------------------------------------------------------------------------
+// Targets of apply_type_many(): the distinct types are deserialized
+// once, while the GIL is held; apply() can then run without it.
+struct apply_targets_t
+{
+  struct type_slot_t
+  {
+    bool ok;
+    bool del;
+    tinfo_t tif;
+  };
+  qvector<type_slot_t> types;
+  eavec_t eas;
+  intvec_t type_idx;  // one per ea, index into 'types'
+
+  typedef std::map<std::pair<qstring, qstring>, int> type_indexes_t;
+  type_indexes_t indexes;
+  til_t *ti;
+
+  // 'py_type' must be a type string, and 'py_fields' a fields string or None
+  int add_type(PyObject *py_type, PyObject *py_fields)
+  {
+    if ( !PyString_Check(py_type) || !PyWStringOrNone_Check(py_fields) )
+      return -1;
+    const type_t *type = (const type_t *) PyString_AsString(py_type);
+    const p_list *fields = PyW_Fields(py_fields);
+    std::pair<qstring, qstring> key(
+            qstring((const char *) type),
+            qstring(fields != NULL ? (const char *) fields : ""));
+    type_indexes_t::iterator p = indexes.find(key);
+    if ( p != indexes.end() )
+      return p->second;
+    int idx = types.size();
+    type_slot_t &slot = types.push_back();
+    slot.del = type[0] == '\0';
+    slot.ok = slot.del || deserialize_cached(&slot.tif, ti, type, fields);
+    indexes[key] = idx;
+    return idx;
+  }
+
+  // 'py_type' is a type string, or a (type, fields) tuple
+  int add_type(PyObject *py_type)
+  {
+    if ( PyString_Check(py_type) )
+      return add_type(py_type, Py_None);
+    if ( !PyTuple_Check(py_type) || PyTuple_Size(py_type) != 2 )
+      return -1;
+    return add_type(PyTuple_GetItem(py_type, 0), PyTuple_GetItem(py_type, 1));
+  }
+
+  bool init(til_t *_ti, PyObject *targets)
+  {
+    ti = _ti;
+    // (eas, one_type): the second item is a type, not an (ea, ...) tuple
+    if ( PyTuple_Check(targets) && PyTuple_Size(targets) == 2 )
+    {
+      PyObject *py_eas = PyTuple_GetItem(targets, 0);
+      PyObject *py_type = PyTuple_GetItem(targets, 1);
+      if ( PyString_Check(py_type)
+        || (PyTuple_Check(py_type)
+         && PyTuple_Size(py_type) == 2
+         && PyString_Check(PyTuple_GetItem(py_type, 0))) )
+      {
+        int idx = add_type(py_type);
+        if ( idx < 0 || PyW_PyListToEaVec(&eas, py_eas) < 0 )
+          return false;
+        type_idx.resize(eas.size(), idx);
+        return true;
+      }
+    }
+    if ( !PySequence_Check(targets) || PyString_Check(targets) )
+      return false;
+    Py_ssize_t n = PySequence_Size(targets);
+    eas.reserve(n);
+    type_idx.reserve(n);
+    for ( Py_ssize_t i = 0; i < n; ++i )
+    {
+      newref_t item(PySequence_GetItem(targets, i));
+      if ( item == NULL || !PyTuple_Check(item.o) || PyTuple_Size(item.o) != 3 )
+        return false;
+      uint64 ea;
+      if ( !PyW_GetNumber(PyTuple_GetItem(item.o, 0), &ea) )
+        return false;
+      int idx = add_type(PyTuple_GetItem(item.o, 1), PyTuple_GetItem(item.o, 2));
+      if ( idx < 0 )
+        return false;
+      eas.push_back(ea_t(ea));
+      type_idx.push_back(idx);
+    }
+    return true;
+  }
+
+  void apply(bytevec_t *bitmap, int flags) const
+  {
+    bitmap->resize((eas.size() + 7) / 8, 0);
+    for ( size_t i = 0; i < eas.size(); ++i )
+    {
+      const type_slot_t &slot = types[type_idx[i]];
+      if ( slot.ok && apply_tinfo_to_ea(eas[i], slot.del ? NULL : &slot.tif, flags) )
+        (*bitmap)[i / 8] |= uint8(1 << (i % 8));
+    }
+  }
+};
+
+//-------------------------------------------------------------------------
+static void ida_typeinf_term(void)
+{
+  clear_type_cache();
+  idapython_unhook_from_notification_point(HT_IDB, type_cache_on_idb_event, NULL);
+}
+
+//-------------------------------------------------------------------------
+static void ida_typeinf_closebase(void)
+{
+  clear_type_cache();
+}
+
 //-------------------------------------------------------------------------
 // tuple(type_str, fields_str, field_cmts) on success
 static PyObject *py_tinfo_t_serialize(
@@ -747,5 +1020,8 @@ static PyObject *py_tinfo_t_serialize(
 }
 //</code(py_typeinf)>
 
+//<init(py_typeinf)>
+idapython_hook_to_notification_point(HT_IDB, type_cache_on_idb_event, NULL);
+//</init(py_typeinf)>
 
 #endif
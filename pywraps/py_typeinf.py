@@ -4,6 +4,18 @@ import ida_idaapi
 ida_idaapi._listify_types(
     reginfovec_t)
 
+def apply_type_many_result(bitmap, count=None):
+    """
+    Unpack the result of apply_type_many()
+
+    @param bitmap: the string returned by apply_type_many()
+    @param count: the number of targets (defaults to 8 * len(bitmap))
+    @return: a list of booleans, one per target
+    """
+    if count is None:
+        count = len(bitmap) * 8
+    return [(ord(bitmap[i >> 3]) >> (i & 7)) & 1 != 0 for i in xrange(count)]
+
 #</pycode(py_typeinf)>
 
 #<pycode_BC695(py_typeinf)>
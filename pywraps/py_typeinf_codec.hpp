@@ -0,0 +1,635 @@
+#ifndef __PY_TYPEINF_CODEC__
+#define __PY_TYPEINF_CODEC__
+
+//<code(py_typeinf_codec)>
+//-------------------------------------------------------------------------
+//                          typed data codec
+//-------------------------------------------------------------------------
+// A type, flattened into a vector of nodes (node #0 being the root), that
+// describes how to convert between its packed bytes and Python objects.
+enum tcodec_kind_t
+{
+  TCK_INT,      // integers, enums, pointers (of any size)
+  TCK_FLOAT,    // 4-byte floating point
+  TCK_DOUBLE,   // 8-byte floating point
+  TCK_STR,      // array of chars
+  TCK_RAW,      // anything else: the bytes, as a 'str'
+  TCK_ARRAY,
+  TCK_STRUCT,
+  TCK_UNION,
+};
+
+struct tcodec_member_t
+{
+  qstring name;
+  uint64 bitoff;    // offset from the start of the enclosing struct, in bits
+  uint32 nbits;     // bitfields only
+  int node;         // -1 for bitfields
+  bool bf_signed;
+};
+DECLARE_TYPE_AS_MOVABLE(tcodec_member_t);
+
+struct tcodec_node_t
+{
+  tcodec_kind_t kind;
+  bool is_signed;
+  size_t size;      // in bytes
+  int elem;         // TCK_ARRAY: element node
+  size_t nelems;    // TCK_ARRAY
+  qvector<tcodec_member_t> members; // TCK_STRUCT, TCK_UNION
+  size_t name0;     // index of the first member name in 'py_names'
+  tcodec_node_t() : kind(TCK_RAW), is_signed(false), size(0), elem(-1), nelems(0), name0(0) {}
+};
+DECLARE_TYPE_AS_MOVABLE(tcodec_node_t);
+
+//-------------------------------------------------------------------------
+static uint64 tcodec_get_uint(const uchar *p, size_t n, bool be)
+{
+  uint64 v = 0;
+  if ( be )
+  {
+    for ( size_t i = 0; i < n; ++i )
+      v = (v << 8) | p[i];
+  }
+  else
+  {
+    for ( size_t i = n; i > 0; --i )
+      v = (v << 8) | p[i-1];
+  }
+  return v;
+}
+
+static void tcodec_put_uint(uchar *p, size_t n, uint64 v, bool be)
+{
+  for ( size_t i = 0; i < n; ++i, v >>= 8 )
+    p[be ? n - 1 - i : i] = uchar(v);
+}
+
+static PyObject *tcodec_int_to_pyobj(uint64 v, size_t nbits, bool is_signed)
+{
+  if ( is_signed )
+  {
+    int64 s = int64(v);
+    if ( nbits > 0 && nbits < 64 && (v & (uint64(1) << (nbits - 1))) != 0 )
+      s = int64(v | (~uint64(0) << nbits));
+    if ( s >= LONG_MIN && s <= LONG_MAX )
+      return PyInt_FromLong(long(s));
+    return PyLong_FromLongLong(s);
+  }
+  if ( v <= uint64(LONG_MAX) )
+    return PyInt_FromLong(long(v));
+  return PyLong_FromUnsignedLongLong(v);
+}
+
+//-------------------------------------------------------------------------
+// Bitfields: the bytes covering the field are read as one integer, in the
+// byte order of the database. On little-endian targets, 'shift' counts
+// bits from the least significant bit of that integer; on big-endian
+// ones, from the most significant bit.
+static inline int tcodec_bitfield_shift(int shift, size_t nbits, size_t nbytes, bool be)
+{
+  return be ? int(nbytes * 8 - shift - nbits) : shift;
+}
+
+static uint64 tcodec_get_bitfield(const uchar *q, int shift, size_t nbits, bool be)
+{
+  size_t nbytes = (shift + nbits + 7) / 8;
+  uint64 v = tcodec_get_uint(q, nbytes, be) >> tcodec_bitfield_shift(shift, nbits, nbytes, be);
+  if ( nbits < 64 )
+    v &= (uint64(1) << nbits) - 1;
+  return v;
+}
+
+static void tcodec_put_bitfield(uchar *q, int shift, size_t nbits, uint64 v, bool be)
+{
+  size_t nbytes = (shift + nbits + 7) / 8;
+  int sh = tcodec_bitfield_shift(shift, nbits, nbytes, be);
+  uint64 mask = (nbits < 64 ? (uint64(1) << nbits) - 1 : ~uint64(0)) << sh;
+  uint64 cur = tcodec_get_uint(q, nbytes, be);
+  cur = (cur & ~mask) | ((v << sh) & mask);
+  tcodec_put_uint(q, nbytes, cur, be);
+}
+
+//-------------------------------------------------------------------------
+struct tinfo_codec_impl_t
+{
+  qvector<tcodec_node_t> nodes;
+  qstring errbuf;
+  bool tuples;    // decode structs as tuples rather than dicts
+  bool cstrings;  // decode char arrays up to their first NUL
+  bool be;
+
+  tinfo_codec_impl_t() : tuples(false), cstrings(false), be(inf.is_be()) {}
+
+  int compile(const tinfo_t &tif, int depth);
+  PyObject *decode(int n, const uchar *p) const;
+  bool encode(uchar *p, int n, PyObject *obj) const;
+
+  // the member names of all the struct/union nodes, so that the dict
+  // keys are created only once
+  qvector<PyObject *> py_names;
+  void build_names();
+};
+
+//-------------------------------------------------------------------------
+int tinfo_codec_impl_t::compile(const tinfo_t &tif, int depth)
+{
+  if ( depth > 64 )
+  {
+    errbuf = "type nested too deeply";
+    return -1;
+  }
+  size_t size = tif.get_size();
+  if ( size == BADSIZE )
+  {
+    qstring tname;
+    tif.print(&tname);
+    errbuf.sprnt("type has no size: %s", tname.c_str());
+    return -1;
+  }
+  int idx = int(nodes.size());
+  nodes.push_back();
+  tcodec_node_t n;
+  n.size = size;
+  if ( tif.is_udt() )
+  {
+    udt_type_data_t udt;
+    if ( !tif.get_udt_details(&udt) )
+    {
+      errbuf = "could not retrieve the struct details";
+      return -1;
+    }
+    n.kind = udt.is_union ? TCK_UNION : TCK_STRUCT;
+    for ( size_t i = 0; i < udt.size(); ++i )
+    {
+      const udt_member_t &m = udt[i];
+      tcodec_member_t &cm = n.members.push_back();
+      cm.name = m.name;
+      cm.bitoff = m.offset;
+      cm.nbits = 0;
+      cm.node = -1;
+      cm.bf_signed = false;
+      bitfield_type_data_t bi;
+      if ( m.is_bitfield() && m.type.get_bitfield_details(&bi) )
+      {
+        cm.nbits = uint32(m.size);
+        cm.bf_signed = !bi.is_unsigned;
+        // the bytes covering the bitfield are handled as one uint64
+        if ( cm.bitoff % 8 + cm.nbits > 64 )
+        {
+          errbuf.sprnt("bitfield spans more than 8 bytes: %s", m.name.c_str());
+          return -1;
+        }
+      }
+      else
+      {
+        cm.node = compile(m.type, depth + 1);
+        if ( cm.node < 0 )
+          return -1;
+      }
+    }
+  }
+  else if ( tif.is_array() )
+  {
+    array_type_data_t ai;
+    if ( !tif.get_array_details(&ai) )
+    {
+      errbuf = "could not retrieve the array details";
+      return -1;
+    }
+    size_t esize = ai.elem_type.get_size();
+    if ( (ai.elem_type.is_char() || ai.elem_type.is_uchar()) && esize == 1 )
+    {
+      n.kind = TCK_STR;
+    }
+    else
+    {
+      n.kind = TCK_ARRAY;
+      n.nelems = esize == 0 || esize == BADSIZE ? 0 : size / esize;
+      n.elem = compile(ai.elem_type, depth + 1);
+      if ( n.elem < 0 )
+        return -1;
+    }
+  }
+  else if ( tif.is_floating() && (size == 4 || size == 8) )
+  {
+    n.kind = size == 4 ? TCK_FLOAT : TCK_DOUBLE;
+  }
+  else if ( (tif.is_integral() || tif.is_enum() || tif.is_bool() || tif.is_ptr())
+         && size > 0 )
+  {
+    n.kind = TCK_INT;
+    n.is_signed = !tif.is_ptr() && tif.is_signed();
+  }
+  else
+  {
+    n.kind = TCK_RAW;
+  }
+  nodes[idx] = n;
+  return idx;
+}
+
+//-------------------------------------------------------------------------
+void tinfo_codec_impl_t::build_names()
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  for ( size_t i = 0; i < nodes.size(); ++i )
+  {
+    tcodec_node_t &n = nodes[i];
+    n.name0 = py_names.size();
+    for ( size_t j = 0; j < n.members.size(); ++j )
+      py_names.push_back(PyString_FromString(n.members[j].name.c_str()));
+  }
+}
+
+//-------------------------------------------------------------------------
+// Decode the node #n, stored at 'p'
+PyObject *tinfo_codec_impl_t::decode(int ni, const uchar *p) const
+{
+  const tcodec_node_t &n = nodes[ni];
+  switch ( n.kind )
+  {
+    case TCK_INT:
+      if ( n.size <= 8 )
+        return tcodec_int_to_pyobj(tcodec_get_uint(p, n.size, be), n.size * 8, n.is_signed);
+      return _PyLong_FromByteArray(p, n.size, !be, n.is_signed);
+    case TCK_FLOAT:
+      {
+        uint32 v = uint32(tcodec_get_uint(p, 4, be));
+        float f;
+        memcpy(&f, &v, sizeof(f));
+        return PyFloat_FromDouble(f);
+      }
+    case TCK_DOUBLE:
+      {
+        uint64 v = tcodec_get_uint(p, 8, be);
+        double d;
+        memcpy(&d, &v, sizeof(d));
+        return PyFloat_FromDouble(d);
+      }
+    case TCK_STR:
+      if ( cstrings )
+      {
+        const uchar *end = (const uchar *) memchr(p, 0, n.size);
+        return PyString_FromStringAndSize((const char *) p, end != NULL ? end - p : n.size);
+      }
+      // fallthrough
+    case TCK_RAW:
+      return PyString_FromStringAndSize((const char *) p, n.size);
+    case TCK_ARRAY:
+      {
+        size_t esize = nodes[n.elem].size;
+        newref_t py_list(PyList_New(n.nelems));
+        for ( size_t i = 0; i < n.nelems; ++i )
+        {
+          PyObject *o = decode(n.elem, p + i * esize);
+          if ( o == NULL )
+            return NULL;
+          PyList_SetItem(py_list.o, i, o);
+        }
+        py_list.incref();
+        return py_list.o;
+      }
+    case TCK_STRUCT:
+    case TCK_UNION:
+      {
+        newref_t py_res(tuples ? PyTuple_New(n.members.size()) : PyDict_New());
+        for ( size_t i = 0; i < n.members.size(); ++i )
+        {
+          const tcodec_member_t &m = n.members[i];
+          PyObject *o;
+          if ( m.node < 0 )
+          {
+            uint64 v = tcodec_get_bitfield(p + m.bitoff / 8, int(m.bitoff % 8), m.nbits, be);
+            o = tcodec_int_to_pyobj(v, m.nbits, m.bf_signed);
+          }
+          else
+          {
+            o = decode(m.node, p + m.bitoff / 8);
+          }
+          if ( o == NULL )
+            return NULL;
+          if ( tuples )
+          {
+            PyTuple_SetItem(py_res.o, i, o);
+          }
+          else
+          {
+            PyDict_SetItem(py_res.o, py_names[n.name0 + i], o);
+            Py_DECREF(o);
+          }
+        }
+        py_res.incref();
+        return py_res.o;
+      }
+  }
+  Py_RETURN_NONE;
+}
+
+//-------------------------------------------------------------------------
+// Encode 'obj' as node #n, at 'p' (which is zero-initialized)
+bool tinfo_codec_impl_t::encode(uchar *p, int ni, PyObject *obj) const
+{
+  const tcodec_node_t &n = nodes[ni];
+  switch ( n.kind )
+  {
+    case TCK_INT:
+      {
+        if ( !PyInt_Check(obj) && !PyLong_Check(obj) )
+        {
+          PyErr_SetString(PyExc_TypeError, "integer expected");
+          return false;
+        }
+        if ( n.size <= 8 )
+        {
+          uint64 v = PyInt_Check(obj)
+                   ? uint64(int64(PyInt_AsLong(obj)))
+                   : PyLong_AsUnsignedLongLongMask(obj);
+          tcodec_put_uint(p, n.size, v, be);
+          return !PyErr_Occurred();
+        }
+        newref_t py_long(PyNumber_Long(obj));
+        return py_long != NULL
+            && _PyLong_AsByteArray((PyLongObject *) py_long.o, p, n.size, !be, n.is_signed) == 0;
+      }
+    case TCK_FLOAT:
+    case TCK_DOUBLE:
+      {
+        double d = PyFloat_AsDouble(obj);
+        if ( d == -1.0 && PyErr_Occurred() )
+          return false;
+        if ( n.kind == TCK_FLOAT )
+        {
+          float f = float(d);
+          uint32 v;
+          memcpy(&v, &f, sizeof(v));
+          tcodec_put_uint(p, 4, v, be);
+        }
+        else
+        {
+          uint64 v;
+          memcpy(&v, &d, sizeof(v));
+          tcodec_put_uint(p, 8, v, be);
+        }
+        return true;
+      }
+    case TCK_STR:
+    case TCK_RAW:
+      {
+        char *buf;
+        Py_ssize_t len;
+        if ( PyString_AsStringAndSize(obj, &buf, &len) < 0 )
+          return false;
+        memcpy(p, buf, qmin(size_t(len), n.size));
+        return true;
+      }
+    case TCK_ARRAY:
+      {
+        newref_t py_seq(PySequence_Fast(obj, "sequence expected"));
+        if ( py_seq == NULL )
+          return false;
+        size_t esize = nodes[n.elem].size;
+        size_t cnt = qmin(size_t(PySequence_Fast_GET_SIZE(py_seq.o)), n.nelems);
+        for ( size_t i = 0; i < cnt; ++i )
+          if ( !encode(p + i * esize, n.elem, PySequence_Fast_GET_ITEM(py_seq.o, i)) )
+            return false;
+        return true;
+      }
+    case TCK_STRUCT:
+    case TCK_UNION:
+      {
+        bool is_dict = PyDict_Check(obj);
+        newref_t py_seq(is_dict ? NULL : PySequence_Fast(obj, "dict or sequence expected"));
+        if ( !is_dict && py_seq == NULL )
+          return false;
+        size_t cnt = is_dict ? n.members.size() : size_t(PySequence_Fast_GET_SIZE(py_seq.o));
+        cnt = qmin(cnt, n.members.size());
+        for ( size_t i = 0; i < cnt; ++i )
+        {
+          const tcodec_member_t &m = n.members[i];
+          // missing members are left zeroed
+          PyObject *o = is_dict
+                      ? PyDict_GetItem(obj, py_names[n.name0 + i])
+                      : PySequence_Fast_GET_ITEM(py_seq.o, i);
+          if ( o == NULL || o == Py_None )
+            continue;
+          if ( m.node < 0 )
+          {
+            if ( !PyInt_Check(o) && !PyLong_Check(o) )
+            {
+              PyErr_SetString(PyExc_TypeError, "integer expected");
+              return false;
+            }
+            uint64 v = PyInt_Check(o)
+                     ? uint64(int64(PyInt_AsLong(o)))
+                     : PyLong_AsUnsignedLongLongMask(o);
+            tcodec_put_bitfield(p + m.bitoff / 8, int(m.bitoff % 8), m.nbits, v, be);
+          }
+          else if ( !encode(p + m.bitoff / 8, m.node, o) )
+          {
+            return false;
+          }
+        }
+        return true;
+      }
+  }
+  return true;
+}
+//</code(py_typeinf_codec)>
+
+//<inline(py_typeinf_codec)>
+//-------------------------------------------------------------------------
+/*
+#<pydoc>
+class tinfo_codec_t(object):
+    """
+    Converts between the packed bytes of a type and Python objects,
+    without going through IDC objects like unpack_object_from_bv() and
+    pack_object_to_bv() do. The type is analyzed once, when the codec
+    is created.
+
+    Decoded values are:
+      - integers, enums, pointers: int or long
+      - floats and doubles: float
+      - char arrays, and types the codec doesn't know about: str
+      - arrays: list
+      - structs and unions: dict (or tuple, with TCF_TUPLES), by member
+
+    Example::
+        tif = tinfo_t()
+        tif.get_named_type(None, "IMAGE_SECTION_HEADER")
+        codec = tinfo_codec_t(tif, TCF_CSTRINGS)
+        sections = codec.decode_array(get_bytes(ea, 40 * n))
+    """
+    def __init__(self, tif, flags=0):
+        """
+        @param tif: the type
+        @param flags: combination of TCF_... flags:
+                      TCF_TUPLES - decode structs as tuples
+                      TCF_CSTRINGS - decode char arrays up to their first NUL
+        """
+        pass
+    def ok(self):
+        """Returns True if the type could be compiled"""
+        pass
+    def error(self):
+        """Returns the reason why the type could not be compiled"""
+        pass
+    def size(self):
+        """Returns the size of the type"""
+        pass
+    def decode(self, buf, offset=0):
+        """Decodes one object, stored at 'offset' in 'buf'"""
+        pass
+    def decode_array(self, buf, count=-1, offset=0, stride=0):
+        """
+        Decodes consecutive objects
+        @param count: number of objects, or -1 for as many as 'buf' holds
+        @param stride: distance between 2 objects, or 0 for the type size
+        @return: a list
+        """
+        pass
+    def encode(self, obj):
+        """
+        Encodes one object. Structs can be passed as dicts (missing
+        members are zeroed) or sequences.
+        @return: a 'str'
+        """
+        pass
+    def encode_array(self, objs):
+        """Encodes a sequence of objects, one after the other"""
+        pass
+#</pydoc>
+*/
+#define TCF_TUPLES   0x0001 // decode structs as tuples rather than dicts
+#define TCF_CSTRINGS 0x0002 // decode char arrays up to their first NUL
+class tinfo_codec_t
+{
+  tinfo_codec_impl_t impl;
+  bool compiled;
+
+  // 'impl.py_names' holds references: copies would release them twice
+  tinfo_codec_t(const tinfo_codec_t &);
+  tinfo_codec_t &operator=(const tinfo_codec_t &);
+
+  bool check(PyObject *py_buf, const uchar **pbuf, Py_ssize_t *plen) const
+  {
+    if ( !compiled )
+    {
+      PyErr_SetString(PyExc_ValueError, impl.errbuf.c_str());
+      return false;
+    }
+    char *buf;
+    if ( PyString_AsStringAndSize(py_buf, &buf, plen) < 0 )
+      return false;
+    *pbuf = (const uchar *) buf;
+    return true;
+  }
+
+public:
+  tinfo_codec_t(const tinfo_t &tif, int flags=0)
+  {
+    impl.tuples = (flags & TCF_TUPLES) != 0;
+    impl.cstrings = (flags & TCF_CSTRINGS) != 0;
+    compiled = impl.compile(tif, 0) == 0;
+    if ( compiled )
+      impl.build_names();
+  }
+
+  ~tinfo_codec_t()
+  {
+    PYW_GIL_CHECK_LOCKED_SCOPE();
+    for ( size_t i = 0; i < impl.py_names.size(); ++i )
+      Py_DECREF(impl.py_names[i]);
+  }
+
+  bool ok() const { return compiled; }
+  const char *error() const { return impl.errbuf.c_str(); }
+  size_t size() const { return compiled ? impl.nodes[0].size : 0; }
+
+  PyObject *decode(PyObject *buf, size_t offset=0) const
+  {
+    PYW_GIL_CHECK_LOCKED_SCOPE();
+    const uchar *p;
+    Py_ssize_t len;
+    if ( !check(buf, &p, &len) )
+      return NULL;
+    if ( offset > size_t(len) || size_t(len) - offset < size() )
+    {
+      PyErr_SetString(PyExc_ValueError, "buffer too small");
+      return NULL;
+    }
+    return impl.decode(0, p + offset);
+  }
+
+  PyObject *decode_array(PyObject *buf, ssize_t count=-1, size_t offset=0, size_t stride=0) const
+  {
+    PYW_GIL_CHECK_LOCKED_SCOPE();
+    const uchar *p;
+    Py_ssize_t len;
+    if ( !check(buf, &p, &len) )
+      return NULL;
+    size_t sz = size();
+    if ( stride == 0 )
+      stride = sz;
+    size_t avail = 0;
+    if ( offset <= size_t(len) && size_t(len) - offset >= sz && stride != 0 )
+      avail = (size_t(len) - offset - sz) / stride + 1;
+    if ( count < 0 )
+      count = avail;
+    if ( size_t(count) > avail )
+    {
+      PyErr_SetString(PyExc_ValueError, "buffer too small");
+      return NULL;
+    }
+    newref_t py_list(PyList_New(count));
+    for ( ssize_t i = 0; i < count; ++i )
+    {
+      PyObject *o = impl.decode(0, p + offset + i * stride);
+      if ( o == NULL )
+        return NULL;
+      PyList_SetItem(py_list.o, i, o);
+    }
+    py_list.incref();
+    return py_list.o;
+  }
+
+  PyObject *encode(PyObject *obj) const
+  {
+    PYW_GIL_CHECK_LOCKED_SCOPE();
+    if ( !compiled )
+    {
+      PyErr_SetString(PyExc_ValueError, impl.errbuf.c_str());
+      return NULL;
+    }
+    bytevec_t bytes;
+    bytes.resize(size(), 0);
+    if ( !impl.encode(bytes.begin(), 0, obj) )
+      return NULL;
+    return PyString_FromStringAndSize((const char *) bytes.begin(), bytes.size());
+  }
+
+  PyObject *encode_array(PyObject *objs) const
+  {
+    PYW_GIL_CHECK_LOCKED_SCOPE();
+    if ( !compiled )
+    {
+      PyErr_SetString(PyExc_ValueError, impl.errbuf.c_str());
+      return NULL;
+    }
+    newref_t py_seq(PySequence_Fast(objs, "sequence expected"));
+    if ( py_seq == NULL )
+      return NULL;
+    size_t n = PySequence_Fast_GET_SIZE(py_seq.o);
+    size_t sz = size();
+    bytevec_t bytes;
+    bytes.resize(n * sz, 0);
+    for ( size_t i = 0; i < n; ++i )
+      if ( !impl.encode(bytes.begin() + i * sz, 0, PySequence_Fast_GET_ITEM(py_seq.o, i)) )
+        return NULL;
+    return PyString_FromStringAndSize((const char *) bytes.begin(), bytes.size());
+  }
+};
+//</inline(py_typeinf_codec)>
+
+#endif
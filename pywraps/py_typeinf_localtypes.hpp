@@ -0,0 +1,441 @@
+#ifndef __PY_TYPEINF_LOCALTYPES__
+#define __PY_TYPEINF_LOCALTYPES__
+
+//<code(py_typeinf_localtypes)>
+//-------------------------------------------------------------------------
+//                    local types bulk export/import
+//-------------------------------------------------------------------------
+// The stream starts with LT_MAGIC and the format version (uint32), and is
+// followed by one record per type; a record is its size (uint32), the
+// storage class (uint32), the record flags (uint32, LTR_...), and 5
+// strings (uint32 length + bytes): name, type, fields, comment and field
+// comments. A zero size ends the stream. All numbers are little-endian.
+//
+// References to other local types by ordinal are replaced with references
+// by name when exporting, so that the records can be imported in any order,
+// into a database where the ordinals differ. Records where this fails
+// (e.g., a reference to an unnamed type) are marked with LTR_ORDINAL_REFS,
+// and are not imported.
+#define LT_MAGIC "IDALTYP\0"
+#define LT_MAGIC_SIZE 8
+#define LT_VERSION 1
+#define LT_CHUNK_SIZE 0x10000
+
+#define LTR_ORDINAL_REFS 0x0001 // the type still refers to other types by ordinal
+
+//-------------------------------------------------------------------------
+static void lt_append_uint32(bytevec_t *out, uint32 v)
+{
+  uchar b[4] = { uchar(v), uchar(v >> 8), uchar(v >> 16), uchar(v >> 24) };
+  out->append(b, sizeof(b));
+}
+
+static void lt_append_str(bytevec_t *out, const void *s, size_t len)
+{
+  lt_append_uint32(out, uint32(len));
+  out->append(s, len);
+}
+
+static bool lt_extract_uint32(uint32 *out, const uchar **pptr, const uchar *end)
+{
+  if ( end - *pptr < 4 )
+    return false;
+  const uchar *p = *pptr;
+  *out = p[0] | (p[1] << 8) | (p[2] << 16) | (uint32(p[3]) << 24);
+  *pptr += 4;
+  return true;
+}
+
+static bool lt_extract_str(qstring *out, const uchar **pptr, const uchar *end)
+{
+  uint32 len;
+  if ( !lt_extract_uint32(&len, pptr, end) || size_t(end - *pptr) < len )
+    return false;
+  out->qclear();
+  out->append((const char *) *pptr, len);
+  *pptr += len;
+  return true;
+}
+
+//-------------------------------------------------------------------------
+// Make every reference to a local type by ordinal a reference by name.
+// Returns true if 'tif' was modified; sets '*unresolved' if a reference
+// could not be replaced (or a part of the type could not be inspected).
+static bool lt_name_ordinal_refs(tinfo_t *tif, bool *unresolved, int depth=0)
+{
+  if ( depth > 64 )
+  {
+    *unresolved = true;
+    return false;
+  }
+  if ( tif->is_typeref() )
+  {
+    uint32 ord = tif->get_ordinal();
+    if ( ord == 0 )
+      return false;
+    const char *name = get_numbered_type_name(NULL, ord);
+    if ( name == NULL || name[0] == '\0' )
+    {
+      *unresolved = true;
+      return false;
+    }
+    tinfo_t target;
+    type_t btmt = BTF_TYPEDEF;
+    if ( target.get_numbered_type(NULL, ord) && !target.is_typeref() )
+    {
+      if ( target.is_union() )
+        btmt = BTF_UNION;
+      else if ( target.is_struct() )
+        btmt = BTF_STRUCT;
+      else if ( target.is_enum() )
+        btmt = BTF_ENUM;
+    }
+    tinfo_t named;
+    if ( !named.create_typedef(typedef_type_data_t(get_idati(), name), btmt, false) )
+    {
+      *unresolved = true;
+      return false;
+    }
+    named.set_modifiers(tif->get_modifiers());
+    *tif = named;
+    return true;
+  }
+  bool changed = false;
+  bool ok = true;
+  if ( tif->is_ptr() )
+  {
+    ptr_type_data_t pi;
+    ok = tif->get_ptr_details(&pi);
+    changed = ok && lt_name_ordinal_refs(&pi.obj_type, unresolved, depth+1);
+    if ( changed )
+      ok = tif->create_ptr(pi);
+  }
+  else if ( tif->is_array() )
+  {
+    array_type_data_t ai;
+    ok = tif->get_array_details(&ai);
+    changed = ok && lt_name_ordinal_refs(&ai.elem_type, unresolved, depth+1);
+    if ( changed )
+      ok = tif->create_array(ai);
+  }
+  else if ( tif->is_func() )
+  {
+    func_type_data_t fi;
+    ok = tif->get_func_details(&fi);
+    if ( ok )
+    {
+      changed = lt_name_ordinal_refs(&fi.rettype, unresolved, depth+1);
+      for ( size_t i = 0; i < fi.size(); ++i )
+        changed |= lt_name_ordinal_refs(&fi[i].type, unresolved, depth+1);
+      if ( changed )
+        ok = tif->create_func(fi);
+    }
+  }
+  else if ( tif->is_udt() )
+  {
+    udt_type_data_t udt;
+    ok = tif->get_udt_details(&udt);
+    if ( ok )
+    {
+      for ( size_t i = 0; i < udt.size(); ++i )
+        changed |= lt_name_ordinal_refs(&udt[i].type, unresolved, depth+1);
+      if ( changed )
+        ok = tif->create_udt(udt, tif->is_union() ? BTF_UNION : BTF_STRUCT);
+    }
+  }
+  if ( !ok )
+  {
+    *unresolved = true;
+    return false;
+  }
+  return changed;
+}
+
+//-------------------------------------------------------------------------
+// Append the record of a local type to 'out'
+static bool lt_append_record(bytevec_t *out, uint32 ordinal)
+{
+  const type_t *type;
+  const p_list *fields;
+  const char *cmt;
+  const p_list *fieldcmts;
+  sclass_t sclass;
+  if ( !get_numbered_type(NULL, ordinal, &type, &fields, &cmt, &fieldcmts, &sclass) )
+    return false;
+  const char *name = get_numbered_type_name(NULL, ordinal);
+  qtype ntype, nfields;
+  uint32 rflags = 0;
+  // ordinals can only be referenced through typedefs, which contain '#'
+  if ( strchr((const char *) type, '#') != NULL )
+  {
+    tinfo_t tif;
+    bool unresolved = false;
+    const type_t *ptype = type;
+    const p_list *pfields = fields;
+    if ( !tif.deserialize(NULL, &ptype, &pfields, NULL) )
+    {
+      rflags |= LTR_ORDINAL_REFS;
+    }
+    else if ( lt_name_ordinal_refs(&tif, &unresolved) && !unresolved )
+    {
+      if ( tif.serialize(&ntype, &nfields, NULL, SUDT_FAST) )
+      {
+        type = ntype.begin();
+        fields = nfields.begin();
+      }
+      else
+      {
+        rflags |= LTR_ORDINAL_REFS;
+      }
+    }
+    if ( unresolved )
+      rflags |= LTR_ORDINAL_REFS;
+  }
+  size_t start = out->size();
+  lt_append_uint32(out, 0);  // patched below
+  lt_append_uint32(out, uint32(sclass));
+  lt_append_uint32(out, rflags);
+  lt_append_str(out, name, name == NULL ? 0 : strlen(name));
+  lt_append_str(out, type, strlen((const char *) type));
+  lt_append_str(out, fields, fields == NULL ? 0 : strlen((const char *) fields));
+  lt_append_str(out, cmt, cmt == NULL ? 0 : strlen(cmt));
+  lt_append_str(out, fieldcmts, fieldcmts == NULL ? 0 : strlen((const char *) fieldcmts));
+  uint32 size = uint32(out->size() - start - 4);
+  for ( int i = 0; i < 4; ++i )
+    (*out)[start+i] = uchar(size >> (8 * i));
+  return true;
+}
+
+//-------------------------------------------------------------------------
+// Write the contents of 'buf' to the file-like object 'py_fp'
+static bool lt_flush(PyObject *py_fp, bytevec_t *buf)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  if ( buf->empty() )
+    return true;
+  newref_t py_res(PyObject_CallMethod(
+                          py_fp, (char *) "write", (char *) "s#",
+                          (const char *) buf->begin(), Py_ssize_t(buf->size())));
+  buf->qclear();
+  return py_res != NULL;
+}
+
+//-------------------------------------------------------------------------
+// Buffered reads from a file-like object
+struct lt_reader_t
+{
+  PyObject *py_fp;
+  bytevec_t buf;
+  size_t pos;
+  bool failed;     // the Python read() raised an exception
+
+  lt_reader_t(PyObject *_py_fp) : py_fp(_py_fp), pos(0), failed(false) {}
+
+  // Make sure 'n' bytes are available at 'pos'
+  bool need(size_t n)
+  {
+    PYW_GIL_CHECK_LOCKED_SCOPE();
+    if ( buf.size() - pos >= n )
+      return true;
+    buf.erase(buf.begin(), buf.begin() + pos);
+    pos = 0;
+    while ( buf.size() < n )
+    {
+      newref_t py_data(PyObject_CallMethod(
+                               py_fp, (char *) "read", (char *) "n",
+                               Py_ssize_t(qmax(n - buf.size(), size_t(LT_CHUNK_SIZE)))));
+      if ( py_data == NULL )
+      {
+        failed = true;
+        return false;
+      }
+      if ( !PyString_Check(py_data.o) || PyString_Size(py_data.o) == 0 )
+        return false;
+      buf.append(PyString_AsString(py_data.o), PyString_Size(py_data.o));
+    }
+    return true;
+  }
+
+  const uchar *take(size_t n)
+  {
+    const uchar *p = buf.begin() + pos;
+    pos += n;
+    return p;
+  }
+};
+
+//-------------------------------------------------------------------------
+// Add a record to the local types
+static bool lt_import_record(const uchar *ptr, const uchar *end, bool replace, bool *skipped)
+{
+  uint32 sclass;
+  uint32 rflags;
+  qstring name, type, fields, cmt, fieldcmts;
+  if ( !lt_extract_uint32(&sclass, &ptr, end)
+    || !lt_extract_uint32(&rflags, &ptr, end)
+    || !lt_extract_str(&name, &ptr, end)
+    || !lt_extract_str(&type, &ptr, end)
+    || !lt_extract_str(&fields, &ptr, end)
+    || !lt_extract_str(&cmt, &ptr, end)
+    || !lt_extract_str(&fieldcmts, &ptr, end)
+    || ptr != end
+    || type.empty()
+    || (rflags & LTR_ORDINAL_REFS) != 0 )
+  {
+    return false;
+  }
+  *skipped = false;
+  uint32 ordinal = name.empty() ? 0 : get_type_ordinal(NULL, name.c_str());
+  int ntf_flags = 0;
+  if ( ordinal != 0 )
+  {
+    if ( !replace )
+    {
+      *skipped = true;
+      return true;
+    }
+    ntf_flags |= NTF_REPLACE;
+  }
+  else
+  {
+    ordinal = alloc_type_ordinal(NULL);
+  }
+  sclass_t sc = sclass_t(sclass);
+  tinfo_code_t code = set_numbered_type(
+          NULL,
+          ordinal,
+          ntf_flags,
+          name.empty() ? NULL : name.c_str(),
+          (const type_t *) type.c_str(),
+          (const p_list *) fields.c_str(),
+          cmt.empty() ? NULL : cmt.c_str(),
+          (const p_list *) fieldcmts.c_str(),
+          &sc);
+  if ( code != TERR_OK )
+  {
+    // don't leave an empty ordinal behind
+    if ( (ntf_flags & NTF_REPLACE) == 0 )
+      del_numbered_type(NULL, ordinal);
+    return false;
+  }
+  return true;
+}
+//</code(py_typeinf_localtypes)>
+
+//<inline(py_typeinf_localtypes)>
+//-------------------------------------------------------------------------
+/*
+#<pydoc>
+def export_local_types(fp):
+    """
+    Write all the local types to a file-like object, in a compact
+    binary form that import_local_types() can read back.
+
+    References to other local types are stored by name, so the types
+    can be imported into a database whose ordinals differ. Types that
+    refer to unnamed types are exported too, but import_local_types()
+    counts them as failed.
+
+    @param fp: an object with a write(str) method, such as a file
+               opened in binary mode
+    @return: the number of exported types
+    """
+    pass
+#</pydoc>
+*/
+PyObject *py_export_local_types(PyObject *fp)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  bytevec_t buf;
+  buf.append(LT_MAGIC, LT_MAGIC_SIZE);
+  lt_append_uint32(&buf, LT_VERSION);
+  uint32 qty = get_ordinal_qty(NULL);
+  Py_ssize_t count = 0;
+  for ( uint32 ord = 1; ord < qty; ++ord )
+  {
+    if ( lt_append_record(&buf, ord) )
+      ++count;
+    if ( buf.size() >= LT_CHUNK_SIZE && !lt_flush(fp, &buf) )
+      return NULL;
+  }
+  lt_append_uint32(&buf, 0);
+  if ( !lt_flush(fp, &buf) )
+    return NULL;
+  return PyInt_FromSsize_t(count);
+}
+
+//-------------------------------------------------------------------------
+/*
+#<pydoc>
+def import_local_types(fp, flags=0):
+    """
+    Read local types written by export_local_types().
+
+    Types are matched by name: an existing type with the same name is
+    kept, unless LTI_REPLACE is specified. Since references to other
+    types are stored by name, the types can be imported in any order.
+
+    @param fp: an object with a read(n) method, such as a file opened
+               in binary mode
+    @param flags: combination of LTI_... flags
+                  LTI_REPLACE - replace existing types with the same name
+    @return: tuple(imported, skipped, failed): numbers of types.
+             'failed' includes the types that refer to other types by
+             ordinal (see export_local_types()).
+             A ValueError is raised if the stream is not in the expected
+             format.
+    """
+    pass
+#</pydoc>
+*/
+#define LTI_REPLACE 0x0001
+PyObject *py_import_local_types(PyObject *fp, int flags=0)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  lt_reader_t reader(fp);
+  uint32 version;
+  if ( !reader.need(LT_MAGIC_SIZE + 4)
+    || memcmp(reader.take(LT_MAGIC_SIZE), LT_MAGIC, LT_MAGIC_SIZE) != 0 )
+  {
+    if ( !reader.failed )
+      PyErr_SetString(PyExc_ValueError, "Not a local types stream");
+    return NULL;
+  }
+  const uchar *ptr = reader.take(4);
+  lt_extract_uint32(&version, &ptr, ptr + 4);
+  if ( version != LT_VERSION )
+  {
+    PyErr_SetString(PyExc_ValueError, "Unsupported local types stream version");
+    return NULL;
+  }
+  bool replace = (flags & LTI_REPLACE) != 0;
+  Py_ssize_t nimported = 0;
+  Py_ssize_t nskipped = 0;
+  Py_ssize_t nfailed = 0;
+  while ( true )
+  {
+    uint32 size;
+    if ( !reader.need(4) )
+      break;
+    ptr = reader.take(4);
+    lt_extract_uint32(&size, &ptr, ptr + 4);
+    if ( size == 0 )
+      return Py_BuildValue("(nnn)", nimported, nskipped, nfailed);
+    if ( !reader.need(size) )
+      break;
+    ptr = reader.take(size);
+    bool skipped;
+    if ( !lt_import_record(ptr, ptr + size, replace, &skipped) )
+      ++nfailed;
+    else if ( skipped )
+      ++nskipped;
+    else
+      ++nimported;
+  }
+  if ( !reader.failed )
+    PyErr_SetString(PyExc_ValueError, "Truncated local types stream");
+  return NULL;
+}
+//</inline(py_typeinf_localtypes)>
+
+#endif
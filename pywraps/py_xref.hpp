@@ -1,4 +1,114 @@
 
+//-------------------------------------------------------------------------
+//<code(py_xref)>
+//-------------------------------------------------------------------------
+// Compressed-sparse-row storage, used by export_xref_graph().
+// The edges of node #i are at [offsets[i], offsets[i+1]) in
+// 'targets' and 'types'.
+struct xref_csr_t
+{
+  qvector<uint32> offsets;
+  eavec_t targets;
+  bytevec_t types;
+
+  void start_node() { offsets.push_back(uint32(targets.size())); }
+  bool node_has_edges() const { return offsets.back() != targets.size(); }
+  void add_edge(ea_t to, uchar type)
+  {
+    targets.push_back(to);
+    types.push_back(type);
+  }
+  void finish() { offsets.push_back(uint32(targets.size())); }
+  void uniq_node_edges();
+
+  PyObject *to_pytuple() const
+  {
+    PYW_GIL_CHECK_LOCKED_SCOPE();
+    newref_t py_offsets(PyW_PackVecToPyString(offsets));
+    newref_t py_targets(PyW_PackVecToPyString(targets));
+    newref_t py_types(PyW_PackVecToPyString(types));
+    return Py_BuildValue("(OOO)", py_offsets.o, py_targets.o, py_types.o);
+  }
+};
+
+//-------------------------------------------------------------------------
+struct xref_edge_t
+{
+  ea_t to;
+  uchar type;
+  bool operator<(const xref_edge_t &r) const
+  {
+    return to < r.to || (to == r.to && type < r.type);
+  }
+  bool operator==(const xref_edge_t &r) const
+  {
+    return to == r.to && type == r.type;
+  }
+};
+DECLARE_TYPE_AS_MOVABLE(xref_edge_t);
+
+//-------------------------------------------------------------------------
+// sort & remove duplicates among the edges of the current node
+void xref_csr_t::uniq_node_edges()
+{
+  size_t start = offsets.back();
+  size_t n = targets.size() - start;
+  if ( n < 2 )
+    return;
+  qvector<xref_edge_t> edges;
+  edges.resize(n);
+  for ( size_t i = 0; i < n; ++i )
+  {
+    edges[i].to = targets[start + i];
+    edges[i].type = types[start + i];
+  }
+  std::sort(edges.begin(), edges.end());
+  xref_edge_t *end = std::unique(edges.begin(), edges.end());
+  n = end - edges.begin();
+  targets.resize(start + n);
+  types.resize(start + n);
+  for ( size_t i = 0; i < n; ++i )
+  {
+    targets[start + i] = edges[i].to;
+    types[start + i] = edges[i].type;
+  }
+}
+
+//-------------------------------------------------------------------------
+// Adds the xrefs from 'frm' to the graphs. If 'pfn' is not NULL, code
+// targets are folded into the entry point of the function they belong
+// to, and references within 'pfn' itself are dropped.
+static void xref_graph_add_xrefs_from(
+        xref_csr_t *code,
+        xref_csr_t *data,
+        ea_t frm,
+        int xflags,
+        const func_t *pfn)
+{
+  xrefblk_t xb;
+  for ( bool ok = xb.first_from(frm, xflags); ok; ok = xb.next_from() )
+  {
+    if ( !xb.iscode )
+    {
+      data->add_edge(xb.to, xb.type);
+      continue;
+    }
+    ea_t to = xb.to;
+    if ( pfn != NULL )
+    {
+      func_t *tfn = get_func(to);
+      if ( tfn != NULL )
+      {
+        if ( tfn->start_ea == pfn->start_ea )
+          continue;
+        to = tfn->start_ea;
+      }
+    }
+    code->add_edge(to, xb.type);
+  }
+}
+//</code(py_xref)>
+
 //-------------------------------------------------------------------------
 //<inline(py_xref)>
 
@@ -96,4 +206,247 @@ bool py_create_switch_table(ea_t ea, const switch_info_t &si)
   create_switch_table(ea, si);
   return true;
 }
+
+//-------------------------------------------------------------------------
+// Flags for export_xref_graph()
+#define EXGF_FUNCS 0x0001 // one node per function, instead of one per instruction
+
+/*
+#<pydoc>
+
+def export_xref_graph(xflags=XREF_FAR, flags=0):
+    """
+    Walk all the functions once, and export the cross-references
+    originating from them as two graphs (code & data) in
+    compressed-sparse-row form.
+
+    The edges of node 'nodes[i]' are targets[offsets[i]:offsets[i+1]],
+    and their xref types (fl_* or dr_* values) are in the same
+    positions in 'types'.
+
+    By default, nodes are the instructions that have at least one
+    outgoing xref. With EXGF_FUNCS, nodes are all the functions
+    entry points instead, code targets are replaced with the entry point
+    of the function they belong to (if any), references within a
+    function are dropped, and duplicate edges are merged.
+
+    All arrays are returned as packed 'str' buffers, in native byte
+    order: 'nodes' and 'targets' hold ea_t's, 'offsets' hold 32-bit
+    unsigned integers, and 'types' hold bytes.
+    See ida_idaapi.unpack_packed_array(), and xref_graph_t.
+
+    @param xflags: combination of XREF_* flags, to filter xrefs
+    @param flags: combination of EXGF_* flags
+    @return: a tuple (nodes, (offsets, targets, types), (offsets, targets, types)),
+             holding the nodes, the code graph and the data graph, respectively
+    """
+    pass
+#</pydoc>
+*/
+static PyObject *export_xref_graph(int xflags=XREF_FAR, int flags=0)
+{
+  eavec_t nodes;
+  xref_csr_t code;
+  xref_csr_t data;
+  bool per_func = (flags & EXGF_FUNCS) != 0;
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  Py_BEGIN_ALLOW_THREADS;
+  for ( size_t i = 0, nfuncs = get_func_qty(); i < nfuncs; ++i )
+  {
+    func_t *pfn = getn_func(i);
+    if ( pfn == NULL )
+      continue;
+    if ( per_func )
+    {
+      nodes.push_back(pfn->start_ea);
+      code.start_node();
+      data.start_node();
+    }
+    func_item_iterator_t fii;
+    for ( bool ok = fii.set(pfn); ok; ok = fii.next_code() )
+    {
+      ea_t ea = fii.current();
+      if ( per_func )
+      {
+        xref_graph_add_xrefs_from(&code, &data, ea, xflags, pfn);
+        continue;
+      }
+      code.start_node();
+      data.start_node();
+      xref_graph_add_xrefs_from(&code, &data, ea, xflags, NULL);
+      if ( code.node_has_edges() || data.node_has_edges() )
+      {
+        nodes.push_back(ea);
+      }
+      else
+      {
+        code.offsets.pop_back();
+        data.offsets.pop_back();
+      }
+    }
+    if ( per_func )
+    {
+      code.uniq_node_edges();
+      data.uniq_node_edges();
+    }
+  }
+  code.finish();
+  data.finish();
+  Py_END_ALLOW_THREADS;
+  newref_t py_nodes(PyW_PackVecToPyString(nodes));
+  newref_t py_code(code.to_pytuple());
+  newref_t py_data(data.to_pytuple());
+  return Py_BuildValue("(OOO)", py_nodes.o, py_code.o, py_data.o);
+}
+
+//-------------------------------------------------------------------------
+/*
+#<pydoc>
+class xref_arrays_t(object):
+    """
+    The xrefs to, or from an address, stored as parallel arrays
+    (frm, to, type, iscode, user), rather than as one Python object
+    per xref. See get_xrefs_to() and get_xrefs_from().
+
+    Indexing returns an object with the 'frm', 'to', 'iscode', 'type'
+    and 'user' attributes (like idautils.XrefsTo() does), while the
+    frms(), tos(), types(), iscodes() and users() methods return the
+    whole arrays at once, as packed buffers.
+    """
+    def collect_to(self, ea, flags):
+        """
+        Replace the contents with the xrefs to 'ea'
+        @param flags: combination of XREF_* flags
+        @return: the number of xrefs
+        """
+        pass
+    def collect_from(self, ea, flags):
+        """
+        Replace the contents with the xrefs from 'ea'
+        @param flags: combination of XREF_* flags
+        @return: the number of xrefs
+        """
+        pass
+#</pydoc>
+*/
+class xref_arrays_t
+{
+  eavec_t _frms;
+  eavec_t _tos;
+  bytevec_t _types;
+  bytevec_t _iscodes;
+  bytevec_t _users;
+
+  void check_index(size_t i) const
+  {
+    if ( i >= _frms.size() )
+      throw std::out_of_range("out of bounds access");
+  }
+
+  void append(const xrefblk_t &xb)
+  {
+    _frms.push_back(xb.from);
+    _tos.push_back(xb.to);
+    _types.push_back(xb.type);
+    _iscodes.push_back(xb.iscode);
+    _users.push_back(xb.user);
+  }
+
+public:
+  void clear()
+  {
+    _frms.qclear();
+    _tos.qclear();
+    _types.qclear();
+    _iscodes.qclear();
+    _users.qclear();
+  }
+
+  size_t collect_to(ea_t ea, int flags=XREF_ALL)
+  {
+    clear();
+    xrefblk_t xb;
+    for ( bool ok = xb.first_to(ea, flags); ok; ok = xb.next_to() )
+      append(xb);
+    return size();
+  }
+
+  size_t collect_from(ea_t ea, int flags=XREF_ALL)
+  {
+    clear();
+    xrefblk_t xb;
+    for ( bool ok = xb.first_from(ea, flags); ok; ok = xb.next_from() )
+      append(xb);
+    return size();
+  }
+
+  size_t size() const { return _frms.size(); }
+  size_t __len__() const { return size(); }
+
+  ea_t frm(size_t i) const { check_index(i); return _frms[i]; }
+  ea_t to(size_t i) const { check_index(i); return _tos[i]; }
+  uchar type(size_t i) const { check_index(i); return _types[i]; }
+  bool iscode(size_t i) const { check_index(i); return _iscodes[i] != 0; }
+  bool user(size_t i) const { check_index(i); return _users[i] != 0; }
+
+  PyObject *_get_entry(size_t i) const
+  {
+    check_index(i);
+    PYW_GIL_CHECK_LOCKED_SCOPE();
+    return Py_BuildValue("(" PY_BV_EA PY_BV_EA "OiO)",
+                         bvea_t(_frms[i]),
+                         bvea_t(_tos[i]),
+                         _iscodes[i] != 0 ? Py_True : Py_False,
+                         int(_types[i]),
+                         _users[i] != 0 ? Py_True : Py_False);
+  }
+
+  PyObject *frms() const { return PyW_PackVecToPyString(_frms); }
+  PyObject *tos() const { return PyW_PackVecToPyString(_tos); }
+  PyObject *types() const { return PyW_PackVecToPyString(_types); }
+  PyObject *iscodes() const { return PyW_PackVecToPyString(_iscodes); }
+  PyObject *users() const { return PyW_PackVecToPyString(_users); }
+};
+
+//-------------------------------------------------------------------------
+/*
+#<pydoc>
+def get_xrefs_to(ea, flags=XREF_ALL):
+    """
+    Collect all the references to 'ea' in one call.
+
+    @param ea: target address
+    @param flags: combination of XREF_* flags
+    @return: an xref_arrays_t instance
+    """
+    pass
+#</pydoc>
+*/
+static xref_arrays_t *get_xrefs_to(ea_t ea, int flags=XREF_ALL)
+{
+  xref_arrays_t *xa = new xref_arrays_t();
+  xa->collect_to(ea, flags);
+  return xa;
+}
+
+//-------------------------------------------------------------------------
+/*
+#<pydoc>
+def get_xrefs_from(ea, flags=XREF_ALL):
+    """
+    Collect all the references from 'ea' in one call.
+
+    @param ea: source address
+    @param flags: combination of XREF_* flags
+    @return: an xref_arrays_t instance
+    """
+    pass
+#</pydoc>
+*/
+static xref_arrays_t *get_xrefs_from(ea_t ea, int flags=XREF_ALL)
+{
+  xref_arrays_t *xa = new xref_arrays_t();
+  xa->collect_from(ea, flags);
+  return xa;
+}
 //</inline(py_xref)>
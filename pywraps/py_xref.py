@@ -5,4 +5,49 @@ import ida_idaapi
 ida_idaapi._listify_types(
         casevec_t)
 
+import collections
+xref_entry_t = collections.namedtuple("xref_entry_t", "frm to iscode type user")
+
+def __xref_arrays_getitem(self, idx):
+    return xref_entry_t(*self._get_entry(idx))
+
+xref_arrays_t.__getitem__ = __xref_arrays_getitem
+xref_arrays_t.__iter__ = ida_idaapi._bounded_getitem_iterator
+
+class xref_graph_t(object):
+    """
+    The results of export_xref_graph(), with the packed buffers
+    turned into sequences of numbers.
+
+    Example::
+        g = xref_graph_t(flags=EXGF_FUNCS)
+        for i, ea in enumerate(g.nodes):
+            for to, xtype in g.code_edges(i):
+                print "0x%x -> 0x%x" % (ea, to)
+    """
+    def __init__(self, xflags=XREF_FAR, flags=0):
+        nodes, code, data = export_xref_graph(xflags, flags)
+        ea_size = 8 if ida_idaapi.__EA64__ else 4
+        unpack = ida_idaapi.unpack_packed_array
+        self.nodes = unpack(nodes, ea_size)
+        self.code_offsets = unpack(code[0], 4)
+        self.code_targets = unpack(code[1], ea_size)
+        self.code_types = unpack(code[2], 1)
+        self.data_offsets = unpack(data[0], 4)
+        self.data_targets = unpack(data[1], ea_size)
+        self.data_types = unpack(data[2], 1)
+
+    def __len__(self):
+        return len(self.nodes)
+
+    def code_edges(self, idx):
+        """Returns the (target, type) code edges of node #idx"""
+        s, e = self.code_offsets[idx], self.code_offsets[idx+1]
+        return zip(self.code_targets[s:e], self.code_types[s:e])
+
+    def data_edges(self, idx):
+        """Returns the (target, type) data edges of node #idx"""
+        s, e = self.data_offsets[idx], self.data_offsets[idx+1]
+        return zip(self.data_targets[s:e], self.data_types[s:e])
+
 #</pycode(py_xref)>
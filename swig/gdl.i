@@ -1,5 +1,7 @@
 %{
 #include <gdl.hpp>
+//<code(py_gdl)>
+//</code(py_gdl)>
 %}
 
 %import "range.i"
@@ -28,7 +30,17 @@
   }
 }
 
+%inline %{
+//<inline(py_gdl)>
+//</inline(py_gdl)>
+%}
+
 %pythoncode %{
 #<pycode(py_gdl)>
 #</pycode(py_gdl)>
 %}
+
+%init %{
+//<init(py_gdl)>
+//</init(py_gdl)>
+%}
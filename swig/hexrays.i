@@ -249,6 +249,16 @@ static void _kludge_use_TPopupMenu(TPopupMenu *m);
      $self->print_func(p);
      return qs;
    }
+
+   ssize_t match_ctree(ctree_matcher_t *matcher, PyObject *callback=NULL)
+   {
+     return matcher->apply(&$self->body, callback);
+   }
+
+   PyObject *export_ctree() const
+   {
+     return export_cfunc_ctree($self);
+   }
 };
 
 %ignore qstring_printer_t::qstring_printer_t(const cfunc_t *, qstring &, bool);
@@ -706,6 +716,7 @@ void qswap(cinsn_t &a, cinsn_t &b);
 
 %ignore decompile_many;
 %rename (decompile_many) py_decompile_many;
+%rename (decompile_batch) py_decompile_batch;
 
 %ignore decompile;
 %ignore decompile_func;
@@ -794,6 +805,36 @@ void qswap(cinsn_t &a, cinsn_t &b);
 
 %ignore Hexrays_Callback;
 
+%{
+//<code(py_hexrays_ctree)>
+//</code(py_hexrays_ctree)>
+%}
+
+%inline %{
+//<inline(py_hexrays_ctree)>
+//</inline(py_hexrays_ctree)>
+%}
+
+%{
+//<code(py_hexrays_cache)>
+//</code(py_hexrays_cache)>
+%}
+
+%inline %{
+//<inline(py_hexrays_cache)>
+//</inline(py_hexrays_cache)>
+%}
+
+%{
+//<code(py_hexrays_batch)>
+//</code(py_hexrays_batch)>
+%}
+
+%inline %{
+//<inline(py_hexrays_batch)>
+//</inline(py_hexrays_batch)>
+%}
+
 %inline %{
 //<inline(py_hexrays_hooks)>
 //</inline(py_hexrays_hooks)>
@@ -822,4 +863,6 @@ void qswap(cinsn_t &a, cinsn_t &b);
 %init %{
 //<init(py_hexrays)>
 //</init(py_hexrays)>
+//<init(py_hexrays_cache)>
+//</init(py_hexrays_cache)>
 %}
@@ -1,5 +1,9 @@
 %{
 #include <kernwin.hpp>
+#include <bytes.hpp>
+#include <segment.hpp>
+#include <fpro.h>
+#include <lines.hpp>
 #include <parsejson.hpp>
 %}
 
@@ -85,6 +89,8 @@ extern plugin_t PLUGIN;
 %ignore set_nav_colorizer;
 %rename (set_nav_colorizer) py_set_nav_colorizer;
 %rename (call_nav_colorizer) py_call_nav_colorizer;
+%rename (set_nav_colormap) py_set_nav_colormap;
+%rename (update_nav_colormap) py_update_nav_colormap;
 
 %ignore get_highlight;
 %rename (get_highlight) py_get_highlight;
@@ -129,6 +135,8 @@ extern plugin_t PLUGIN;
 
 %ignore gen_disasm_text;
 %rename (gen_disasm_text) py_gen_disasm_text;
+%rename (_gen_disasm_text_chunk) py_gen_disasm_text_chunk;
+%rename (export_listing) py_export_listing;
 
 %ignore UI_Hooks::handle_hint_output;
 %ignore UI_Hooks::handle_get_ea_hint_output;
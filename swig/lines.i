@@ -15,6 +15,8 @@
 
 %ignore set_user_defined_prefix;
 %rename (set_user_defined_prefix) py_set_user_defined_prefix;
+%rename (set_user_defined_prefix_range) py_set_user_defined_prefix_range;
+%rename (set_user_defined_prefix_ranges) py_set_user_defined_prefix_ranges;
 
 %ignore generate_disassembly;
 %rename (generate_disassembly) py_generate_disassembly;
@@ -34,6 +36,9 @@
 %ignore tag_advance;
 %rename (tag_advance) py_tag_advance;
 
+%ignore disasm_line_cache_t::render;
+%rename (generate_disasm_lines) py_generate_disasm_lines;
+
 %typemap(argout) (qstring *buf, ea_t ea, int what)
 {
   // typemap(argout) (qstring *buf, ea_t ea, int what)
@@ -55,6 +60,10 @@
 %include "lines.hpp"
 
 %{
+#include <bytes.hpp>
+#include <funcs.hpp>
+#include <ua.hpp>
+#include <idp.hpp>
 //<code(py_lines)>
 //</code(py_lines)>
 %}
@@ -56,6 +56,8 @@ inline qstring py_## FNAME(ea_t ea) { return FNAME(ea); }
 %rename (validate_name) py_validate_name;
 
 %{
+#include <idp.hpp>
+#include <segment.hpp>
 //<code(py_name)>
 //</code(py_name)>
 %}
@@ -105,6 +105,9 @@
 %rename (calc_type_size) py_calc_type_size;
 %ignore apply_type;
 %rename (apply_type) py_apply_type;
+%rename (apply_type_many) py_apply_type_many;
+%rename (export_local_types) py_export_local_types;
+%rename (import_local_types) py_import_local_types;
 
 %ignore use_regarg_type_cb;
 %ignore is_stkarg_load_t;
@@ -141,6 +144,16 @@
 //</code(py_typeinf)>
 %}
 
+%{
+//<code(py_typeinf_codec)>
+//</code(py_typeinf_codec)>
+%}
+
+%{
+//<code(py_typeinf_localtypes)>
+//</code(py_typeinf_localtypes)>
+%}
+
 %extend til_t {
 
   til_t *base(int n)
@@ -277,9 +290,21 @@
 //</inline(py_typeinf)>
 %}
 
+%inline %{
+//<inline(py_typeinf_codec)>
+//</inline(py_typeinf_codec)>
+//<inline(py_typeinf_localtypes)>
+//</inline(py_typeinf_localtypes)>
+%}
+
 %cstring_output_maxsize(char *buf, size_t maxsize);
 
 %pythoncode %{
 #<pycode(py_typeinf)>
 #</pycode(py_typeinf)>
 %}
+
+%init %{
+//<init(py_typeinf)>
+//</init(py_typeinf)>
+%}
@@ -19,6 +19,15 @@
 // 'from' is a reserved Python keyword
 %rename (frm) from;
 
+%newobject get_xrefs_to;
+%newobject get_xrefs_from;
+
+%{
+#include <funcs.hpp>
+//<code(py_xref)>
+//</code(py_xref)>
+%}
+
 %inline %{
 //<inline(py_xref)>
 //</inline(py_xref)>